@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Indices of the objects that need simulating. Objects with nothing left to integrate are
+	/// put to sleep and dropped from the set, so a tick only touches moving objects instead of
+	/// the whole scene. Woken objects rejoin at the start of the next tick.
+	/// </summary>
+	class ActivitySet
+	{
+	public:
+		static constexpr uint32_t INACTIVE = std::numeric_limits<uint32_t>::max();
+
+		/// <summary>
+		/// Track a new object, it starts awake
+		/// </summary>
+		void add(uint32_t index);
+
+		/// <summary>
+		/// Stop tracking an object, pending wakes for it are ignored until the index is added again
+		/// </summary>
+		void remove(uint32_t index);
+
+		void clear();
+
+		/// <summary>
+		/// Queue an object to rejoin the set. Safe to call from any thread.
+		/// </summary>
+		void wake(uint32_t index);
+
+		/// <summary>
+		/// Move the objects woken since the last tick into the set
+		/// </summary>
+		void beginTick();
+
+		/// <summary>
+		/// Drop an object from the set until it is woken again
+		/// </summary>
+		void sleep(uint32_t index);
+
+		bool isActive(uint32_t index) const
+		{
+			return index < m_slots.size() && m_slots[index] != INACTIVE && m_slots[index] != REMOVED;
+		}
+
+		/// <summary>
+		/// Object indices to simulate this tick, unordered
+		/// </summary>
+		const std::vector<uint32_t>& getActive() const
+		{
+			return m_active;
+		}
+
+		size_t getObjectCount() const
+		{
+			return m_object_count;
+		}
+
+	private:
+		static constexpr uint32_t REMOVED = INACTIVE - 1;
+
+		void activate(uint32_t index);
+
+		std::vector<uint32_t> m_active;
+		std::vector<uint32_t> m_slots; // Per object, position in m_active, INACTIVE or REMOVED
+		size_t m_object_count{};
+
+		std::mutex m_wake_mutex;
+		std::vector<uint32_t> m_woken;
+
+	}; // end class
+}; // end namespace
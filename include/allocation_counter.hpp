@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// Counting replaces the global operator new and delete, which is cheap but not free, so it is
+// only built in when XPLOR_COUNT_ALLOCATIONS is defined (Debug builds by default)
+#ifdef XPLOR_COUNT_ALLOCATIONS
+#define XPLOR_ALLOCATION_COUNTER 1
+#else
+#define XPLOR_ALLOCATION_COUNTER 0
+#endif
+
+namespace Xplor
+{
+	/// <summary>
+	/// Calls to the global operator new on any thread since startup, 0 when counting is compiled out.
+	/// The difference over a frame is that frame's heap allocations.
+	/// </summary>
+	uint64_t GetHeapAllocationCount();
+
+	constexpr bool IsAllocationCounterEnabled()
+	{
+		return XPLOR_ALLOCATION_COUNTER != 0;
+	}
+}; // end namespace
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include "xplor_types.hpp"
+
+namespace Xplor
+{
+	struct BroadphasePair {
+		uint32_t a; // User data of the proxies, a < b
+		uint32_t b;
+	};
+
+	/// <summary>
+	/// Incremental sweep and prune over axis aligned bounding boxes. Each axis keeps a sorted
+	/// array of box endpoints. As objects move between ticks the arrays are only slightly out of
+	/// order, so insertion sort restores them in close to linear time, and every swap of a min
+	/// endpoint with a max endpoint is exactly the place where a pair starts or stops overlapping.
+	/// The cost of a tick is O(n + k) for n proxies and k endpoint swaps and changed pairs,
+	/// there is no all pairs test.
+	/// Usage per tick: updateProxy for moved boxes (thread safe for distinct proxies), update,
+	/// then read the begin/persist/end pairs.
+	/// </summary>
+	class SweepAndPrune
+	{
+	public:
+		static constexpr uint32_t INVALID_PROXY = std::numeric_limits<uint32_t>::max();
+
+		/// <summary>
+		/// Register a box, it takes part in the next update
+		/// </summary>
+		/// <param name="user_data">Reported in the overlap pairs, e.g. an object index</param>
+		/// <returns>Proxy used to move or remove the box</returns>
+		uint32_t createProxy(const BoundingBox& bounds, uint32_t user_data);
+
+		/// <summary>
+		/// Remove a box, its overlaps are reported as ended on the next update
+		/// </summary>
+		void destroyProxy(uint32_t proxy);
+
+		/// <summary>
+		/// Move a box. Only stores the bounds, so distinct proxies may be updated from several threads.
+		/// </summary>
+		void updateProxy(uint32_t proxy, const BoundingBox& bounds)
+		{
+			m_proxies[proxy].bounds = bounds;
+		}
+
+		/// <summary>
+		/// Remove every proxy and pair without reporting end events
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Re-sort the endpoints and find the pairs that changed since the last update
+		/// </summary>
+		void update();
+
+		/// <summary>
+		/// Pairs that started overlapping in the last update
+		/// </summary>
+		const std::vector<BroadphasePair>& getBeginPairs() const
+		{
+			return m_begin_pairs;
+		}
+
+		/// <summary>
+		/// Pairs that were overlapping before the last update and still are
+		/// </summary>
+		const std::vector<BroadphasePair>& getPersistPairs() const
+		{
+			return m_persist_pairs;
+		}
+
+		/// <summary>
+		/// Pairs that stopped overlapping in the last update, including pairs of destroyed proxies
+		/// </summary>
+		const std::vector<BroadphasePair>& getEndPairs() const
+		{
+			return m_end_pairs;
+		}
+
+		size_t getProxyCount() const
+		{
+			return m_proxies.size() - m_free_proxies.size() - m_destroyed_proxies.size();
+		}
+
+		/// <summary>
+		/// Endpoint swaps done by the last update, a measure of how much the scene moved
+		/// </summary>
+		size_t getSwapCount() const
+		{
+			return m_swap_count;
+		}
+
+	private:
+		struct Proxy {
+			BoundingBox bounds;
+			uint32_t user_data;
+			bool alive;
+		};
+
+		// Sorted entry on one axis, the value is refreshed from the proxy bounds every update
+		struct Endpoint {
+			float value;
+			uint32_t data; // proxy << 1 | is_max
+		};
+
+		struct OverlapPair {
+			uint32_t proxy_a;
+			uint32_t proxy_b;
+			bool overlapping;     // State after the current update
+			bool was_overlapping; // State after the previous update
+		};
+
+		static uint64_t PairKey(uint32_t a, uint32_t b)
+		{
+			if (a > b)
+				std::swap(a, b);
+			return (static_cast<uint64_t>(a) << 32) | b;
+		}
+
+		bool overlaps(uint32_t a, uint32_t b) const;
+		void addPair(uint32_t a, uint32_t b);
+		void removePair(uint32_t a, uint32_t b);
+
+		void removeDestroyedProxies();
+		void sortAxis(uint32_t axis);
+		void rebuild();
+		void reportPairs();
+
+		std::vector<Proxy> m_proxies;
+		std::vector<uint32_t> m_free_proxies;
+		// Destroyed this tick, their endpoints are still in the axis arrays
+		std::vector<uint32_t> m_destroyed_proxies;
+		size_t m_created_count{}; // Proxies created since the last update
+
+		std::array<std::vector<Endpoint>, 3> m_axes;
+
+		std::vector<OverlapPair> m_pairs;
+		// Pairs begin and end every tick, the pool recycles the map's entries
+		std::pmr::unsynchronized_pool_resource m_lookup_memory;
+		std::pmr::unordered_map<uint64_t, uint32_t> m_pair_lookup{ &m_lookup_memory }; // Key to index in m_pairs
+
+		std::vector<BroadphasePair> m_begin_pairs;
+		std::vector<BroadphasePair> m_persist_pairs;
+		std::vector<BroadphasePair> m_end_pairs;
+		size_t m_swap_count{};
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include "xplor_types.hpp"
+#include "shader.hpp"
+#include "stream_buffer.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Immediate mode debug lines. Primitives added during a frame are written straight into a
+	/// stream buffer in world space and drawn with a single call.
+	/// </summary>
+	class DebugDraw
+	{
+	public:
+		/// <summary>
+		/// Create the vertex array and stream buffer. Requires a current OpenGL context.
+		/// </summary>
+		void init();
+
+		void destroy();
+
+		void beginFrame();
+
+		void addLine(const glm::vec3& start, const glm::vec3& end);
+
+		/// <summary>
+		/// Add the 12 edges of an axis aligned bounding box
+		/// </summary>
+		void addBox(const BoundingBox& box);
+
+		/// <summary>
+		/// Draw every line added this frame. Expects the camera uniform block to be bound.
+		/// </summary>
+		void draw(const std::shared_ptr<Shader>& shader);
+
+		void endFrame();
+
+		/// <summary>
+		/// Bytes of line vertices streamed this frame
+		/// </summary>
+		size_t getUsedSize() const
+		{
+			return m_stream.getUsedSize();
+		}
+
+	private:
+		static constexpr size_t VERTEX_STRIDE = 3 * sizeof(float);
+
+		StreamBuffer m_stream;
+		GLuint m_VAO{};
+		size_t m_vertex_count{};
+
+	}; // end class
+}; // end namespace
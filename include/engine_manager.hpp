@@ -3,14 +3,39 @@
 #include <vector>
 #include <xplor_types.hpp>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "window_manager.hpp"
 #include "camera.hpp"
 #include "game_object.hpp"
+#include "frame_packet.hpp"
+#include "renderer.hpp"
+#include "render_thread.hpp"
+#include "task_graph.hpp"
+#include "broadphase.hpp"
+#include "loose_octree.hpp"
+#include "prefab.hpp"
+#include "scene_bvh.hpp"
+#include "slot_map.hpp"
+#include "frame_arena.hpp"
 #include <iostream>
 #include <fstream>
 
 namespace Xplor
 {
+    struct PickHit {
+        Handle object;
+        uint32_t triangle;      // Triangle index within the object's mesh
+        float t;                // Distance along the picking ray
+        glm::vec3 point;        // World space hit point
+        glm::vec3 barycentrics; // Weights of the triangle's vertices at the hit point
+    };
+
+    struct RaycastHit {
+        Handle object; // Invalid if the ray missed everything
+        float t;       // Distance along the ray direction
+    };
+
     class EngineManager
     {
         // The engine manager should manage all other managers and fit all
@@ -28,11 +53,110 @@ namespace Xplor
         bool run();
 
 
-        // Update all game logic
+        // Run as many fixed ticks as the frame time covers
+        void simulate(float frame_time);
+
+        // One tick of simulation and broadphase
+        void fixedUpdate(float step);
+
+        // Integrate the awake objects and refit their bounds
         void update(float deltaTime);
 
-        // Render all game objects
-        void render(glm::mat4 viewMatrix, glm::mat4 projectionMatrix);
+        // Find overlapping object bounds, results are read through getBroadphase()
+        void updateBroadphase();
+
+        // Collect the objects touching the view frustum
+        void cullObjects(const glm::mat4& view_projection);
+
+        // Build the frame packet from the objects that survived culling
+        void render(const glm::mat4& view_matrix, const glm::mat4& projection_matrix, FramePacket& packet);
+
+        const TaskGraph& getFrameGraph() const
+        {
+            return m_frame_graph;
+        }
+
+        const Renderer& getRenderer() const
+        {
+            return m_renderer;
+        }
+
+        /// <summary>
+        /// Scratch memory for the current frame, reset before the frame graph runs. Only for
+        /// stages that do not run at the same time as another stage using it.
+        /// </summary>
+        FrameArena& getFrameArena()
+        {
+            return m_frame_arena;
+        }
+
+        /// <summary>
+        /// Heap allocations made by any thread during the last frame, 0 unless the allocation
+        /// counter is compiled in
+        /// </summary>
+        uint64_t getFrameAllocationCount() const
+        {
+            return m_frame_allocations;
+        }
+
+        const ActivitySet& getActivitySet() const
+        {
+            return m_activity;
+        }
+
+        /// <summary>
+        /// Overlap pairs of the last tick, the pairs hold object slots (Handle::index)
+        /// </summary>
+        const SweepAndPrune& getBroadphase() const
+        {
+            return m_broadphase;
+        }
+
+        /// <summary>
+        /// Region and nearest neighbour queries over the object bounds, results are object slots (Handle::index)
+        /// </summary>
+        const LooseOctree& getOctree() const
+        {
+            return m_octree;
+        }
+
+        /// <summary>
+        /// Execute OpenGL work such as resource creation on the thread owning the context and wait for it
+        /// </summary>
+        void runOnRenderThread(const std::function<void()>& command)
+        {
+            m_render_thread.runOnRenderThread(command);
+        }
+
+        /// <summary>
+        /// Simulation ticks per second, independent of the frame rate
+        /// </summary>
+        void setTickRate(float ticks_per_second)
+        {
+            m_tick_rate = ticks_per_second;
+        }
+
+        float getFixedTimeStep() const
+        {
+            return 1.0f / m_tick_rate;
+        }
+
+        /// <summary>
+        /// Limit on ticks run in one frame. Once reached the remaining time is dropped, so a
+        /// slow frame can not cause ever more ticks in the next one.
+        /// </summary>
+        void setMaxTicksPerFrame(uint32_t max_ticks)
+        {
+            m_max_ticks_per_frame = max_ticks;
+        }
+
+        /// <summary>
+        /// Submit frames from a dedicated render thread. Must be set before run().
+        /// </summary>
+        void setThreadedRendering(bool enabled)
+        {
+            m_threaded_rendering = enabled;
+        }
 
         static std::shared_ptr<EngineManager> GetInstance();
 
@@ -40,11 +164,90 @@ namespace Xplor
         // We want a method that will add an object into our vector to keep track of
         // so we can update it with all the other ones and render it
 
-        void addGameObject(std::shared_ptr<GameObject> object);
+        Handle addGameObject(std::shared_ptr<GameObject> object);
+
+        /// <summary>
+        /// Take an object out of the scene and every system tracking it. Its handle and any copies
+        /// of it become stale, the slot is reused by later objects. Its GPU resources are deleted on
+        /// the render thread once the packets that may still draw it were drawn. Call between
+        /// frames, not while the frame graph runs.
+        /// </summary>
+        /// <returns>False if the handle was already stale</returns>
+        bool removeGameObject(Handle handle);
+
+        /// <summary>
+        /// Queue an object for removal at the end of the current simulation tick. Safe to call from
+        /// any thread, also while the frame graph runs, and with handles that are already stale.
+        /// Instances of prefabs go back to a pool that spawn() reuses.
+        /// </summary>
+        void despawn(Handle handle);
+
+        /// <summary>
+        /// Objects set to despawn outside the world are removed once their bounds stop touching
+        /// these bounds. Defaults to the octree's root cube.
+        /// </summary>
+        void setWorldBounds(const BoundingBox& bounds)
+        {
+            m_world_bounds = bounds;
+        }
+
+        const BoundingBox& getWorldBounds() const
+        {
+            return m_world_bounds;
+        }
+
+        /// <summary>
+        /// Despawned prefab instances waiting to be reused
+        /// </summary>
+        size_t getPooledObjectCount() const
+        {
+            return m_pooled_object_count;
+        }
+
+        /// <summary>
+        /// Object behind a handle, null once it was removed
+        /// </summary>
+        GameObject* findObject(Handle handle)
+        {
+            std::shared_ptr<GameObject>* object = m_objects.get(handle);
+            return object ? object->get() : nullptr;
+        }
+
+        /// <summary>
+        /// First object with the given name, an invalid handle if there is none
+        /// </summary>
+        Handle findObjectByName(StringId name) const
+        {
+            for (size_t i = 0; i < m_objects.size(); i++)
+            {
+                if (m_objects[i]->getNameId() == name)
+                    return m_objects.getHandle(i);
+            }
+            return {};
+        }
 
         void rayIntersectionTest(const Xplor::Ray& ray);
 
-        bool rayIntersectsAABB(const Xplor::Ray & ray, const BoundingBox& bbox, float& out_t);
+        /// <summary>
+        /// Attach an object to a parent so it follows the parent's transform, or detach it with a null
+        /// parent. The child's position, rotation and scale are kept and become relative to the parent.
+        /// </summary>
+        void setParent(Handle child, Handle parent);
+
+        /// <summary>
+        /// Closest object hit by each ray, traced in SIMD packets through a BVH over the object bounds.
+        /// Meant for batches such as line of sight checks, hover highlighting or marquee selection.
+        /// </summary>
+        /// <param name="rays">Rays with direction_inv filled in</param>
+        /// <param name="out_hits">Per ray, the hit object's handle, invalid for a miss</param>
+        void raycast(const Ray* rays, size_t count, RaycastHit* out_hits);
+
+        /// <summary>
+        /// Exact triangle under a ray. Objects are culled through the scene BVH, then the ray is
+        /// moved into each candidate's local space and tested against its mesh's triangle BVH.
+        /// </summary>
+        /// <returns>False if the ray hits no triangle</returns>
+        bool pick(const Ray& ray, PickHit& out_hit);
 
         void exportScene(std::string filepath)
         {
@@ -64,6 +267,13 @@ namespace Xplor
         void addDebugObject(const glm::vec3& position);
         void addDebugObject(const glm::vec3& position, const glm::vec3& velocity);
 
+        /// <summary>
+        /// Add an instance of a prefab to the scene. Reuses a despawned instance of the same prefab
+        /// when one is pooled, otherwise only allocates the object. Either way it is registered with
+        /// the engine's systems and no resources are created.
+        /// </summary>
+        Handle spawn(const Prefab& prefab, const glm::vec3& position, const glm::vec3& velocity = glm::vec3(0.0f));
+
 
         size_t getObjectCount()
         {
@@ -84,18 +294,116 @@ namespace Xplor
         float m_delta_time; // Time between current and last frame
 
         static std::shared_ptr<EngineManager> m_instance;
-        // Drop templating on this for now, this vector contains every game objects in the scene
-        //std::vector<GameObject> gameObjects;
-        std::vector<std::shared_ptr<GameObject>> m_gameObjects;
+        // Every game object in the scene. Systems key their data by the object's slot, which stays
+        // the same until the object is removed, and iterate the dense array.
+        SlotMap<std::shared_ptr<GameObject>> m_objects;
+
+        GameObject& objectAt(uint32_t slot)
+        {
+            return *m_objects.atSlot(slot);
+        }
+
+        // Objects per simulation/culling/recording job
+        static constexpr size_t RECORD_BATCH_SIZE = 256;
+        // One list per job system thread
+        std::vector<RenderCommandList> m_command_lists;
+        std::vector<std::vector<uint32_t>> m_visible_lists;
+        // Slots of the objects that passed culling this frame
+        std::vector<uint32_t> m_visible_objects;
+
+        SweepAndPrune m_broadphase;
+        LooseOctree m_octree;
+        // Parent/child transforms of every object, the user data is the object slot
+        TransformHierarchy m_transforms;
+        // Objects that moved recently, only these are updated each tick
+        ActivitySet m_activity;
+        // Packed state of the awake objects for the SIMD integrator
+        KinematicsBatch m_kinematics;
+
+        // Ray queries, rebuilt when objects are added or removed and refit when they moved
+        SceneBVH m_scene_bvh;
+        std::vector<BoundingBox> m_scene_bounds;
+        std::vector<Handle> m_scene_bvh_handles; // Object per BVH item, stale once it was removed
+        std::vector<RayHit> m_ray_hits;
+        bool m_scene_bvh_stale{ true };
+        bool m_scene_bvh_rebuild{ true };
+        uint32_t m_scene_bvh_refits{};
+        static constexpr uint32_t REFITS_PER_REBUILD = 120;
+        void updateSceneBVH();
+
+        // Lifetimes, expiries are a min heap on simulation time
+        struct Expiry {
+            double time;
+            Handle handle;
+        };
+        std::vector<Expiry> m_expiries;
+        static bool ExpiresLater(const Expiry& a, const Expiry& b)
+        {
+            return a.time > b.time;
+        }
+        double m_simulation_time{};
+        BoundingBox m_world_bounds{ glm::vec3(-2048.0f), glm::vec3(2048.0f) };
+        std::mutex m_despawn_mutex;
+        std::vector<Handle> m_despawn_queue;
+        std::vector<Handle> m_despawning;
+        // Despawned instances per prefab source, reset and handed out again by spawn()
+        std::unordered_map<const GameObject*, std::vector<std::shared_ptr<GameObject>>> m_object_pools;
+        size_t m_pooled_object_count{};
+        // Removed objects, handed to the next submitted packet which deletes their GPU resources
+        // and drops them on the render thread once it was drawn
+        std::vector<std::shared_ptr<GameObject>> m_released_objects;
+
+        // Queue objects whose time ran out or that left the world
+        void updateLifetimes();
+        // Remove the queued objects, called where no stage reads the object storage
+        void processDespawns();
+        // Take an object out of every system, its GPU resources are left to the caller
+        std::shared_ptr<GameObject> detachGameObject(Handle handle);
+
+        // Stages of a frame and their dependencies
+        TaskGraph m_frame_graph;
+        FrameArena m_frame_arena;
+        uint64_t m_frame_allocations{};
+        FramePacket* m_current_packet{};
+
+        void buildFrameGraph();
+        void registerBroadphase(uint32_t slot);
+        void registerOctree(uint32_t slot);
+        void registerTransform(uint32_t slot);
+
+        // Recompute world matrices that changed this tick and the bounds of children that moved with a parent
+        void updateTransforms();
+        void registerActivity(uint32_t slot);
+        void registerLifetime(const GameObject& object);
+
+        // Wake objects touching something that moved, drop objects that fell asleep from the active set
+        void updateActivity();
+
+        Renderer m_renderer;
+        RenderThread m_render_thread;
+        FramePacket m_packet; // Used when rendering on the main thread
+        bool m_threaded_rendering{ true };
         std::shared_ptr<Camera> m_active_camera;
         float m_last_frame_time{};
+        // Fixed timestep state, alpha is how far the frame is between the last two ticks
+        float m_tick_rate{ 60.0f };
+        uint32_t m_max_ticks_per_frame{ 5 };
+        float m_accumulator{};
+        float m_interpolation_alpha{ 1.0f };
         size_t m_objectCount{};
 
+        // Debug cubes, textured with the shared one texture shader or with their own simple shader
+        std::unique_ptr<Prefab> m_debug_prefab;
+        std::unique_ptr<Prefab> m_debug_simple_prefab;
+        // Projectiles fired from the editor, also removed once they leave the world bounds
+        static constexpr float DEBUG_PROJECTILE_LIFETIME = 10.0f;
+        std::unique_ptr<Prefab> createDebugPrefab(bool simple_shader, float time_to_live = std::numeric_limits<float>::infinity());
+
 
         json SerializeScene() const
         {
             json sceneData;
-            for (const auto& object : m_gameObjects)
+            for (const auto& object : m_objects)
             {
                 sceneData.push_back(object->Serialize());
             }
@@ -105,30 +413,40 @@ namespace Xplor
 
         void DeserializeScene(const json& sceneData)
         {
-            m_gameObjects.clear();
+            for (auto& object : m_objects)
+            {
+                m_released_objects.push_back(std::move(object));
+            }
+            m_objects.clear();
+            m_expiries.clear();
+            {
+                std::lock_guard<std::mutex> lock(m_despawn_mutex);
+                m_despawn_queue.clear();
+            }
+            m_broadphase.clear();
+            m_octree.clear();
+            m_transforms.clear();
+            m_activity.clear();
 
             for (const auto& objectData : sceneData)
             {
                 auto type = objectData.at("type").get<Xplor::GameObjectType>();
+                std::shared_ptr<GameObject> object = CreateGameObject(type);
+                object->Deserialze(objectData);
+                object->setHandle(m_objects.insert(object));
+            }
 
-                switch (type) {
-                case Xplor::GameObjectType::GameObject: {
-                    auto object = std::make_shared<GameObject>();
-                    object->Deserialze(objectData);
-                    m_gameObjects.push_back(object);
-                    break;
-                }
-                case Xplor::GameObjectType::PropObject: {
-                    auto object = std::make_shared<PropObject>();
-                    object->Deserialze(objectData);
-                    m_gameObjects.push_back(object);
-                    break;
-                }
-                default:
-                    assert(false && "Undefined enum value in switch statement");
-                }
-
+            for (size_t i = 0; i < m_objects.size(); i++)
+            {
+                const uint32_t slot = m_objects.getSlot(i);
+                registerTransform(slot);
+                m_objects[i]->updateBoundingBox();
+                registerBroadphase(slot);
+                registerOctree(slot);
+                registerActivity(slot);
+                registerLifetime(*m_objects[i]);
             }
+            m_scene_bvh_rebuild = true;
         }
         
 
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Bump allocator for data that lives for one frame. Allocating moves a pointer, freeing does
+	/// nothing, and reset() releases everything at once. Plugs into std::pmr containers:
+	///     std::pmr::vector<DrawItem> scratch(&arena);
+	/// When a frame needs more than the block holds the rest comes from the heap, and the next
+	/// reset() grows the block to the frame's peak so later frames stay off the heap.
+	/// Not thread safe, stages running at the same time need their own arena.
+	/// </summary>
+	class FrameArena : public std::pmr::memory_resource
+	{
+	public:
+		explicit FrameArena(size_t capacity = 64 * 1024);
+		~FrameArena() override;
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		/// <summary>
+		/// Release everything allocated since the last reset. Containers still using the arena must
+		/// not be touched afterwards.
+		/// </summary>
+		void reset();
+
+		/// <summary>
+		/// Bytes allocated since the last reset, including heap overflow
+		/// </summary>
+		size_t getUsed() const
+		{
+			return m_used + m_overflow_bytes;
+		}
+
+		size_t getCapacity() const
+		{
+			return m_capacity;
+		}
+
+		/// <summary>
+		/// Most bytes used by a single frame so far
+		/// </summary>
+		size_t getPeak() const
+		{
+			return m_peak;
+		}
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+
+	private:
+		struct Overflow {
+			void* data;
+			size_t bytes;
+			size_t alignment;
+		};
+
+		std::byte* m_block{};
+		size_t m_capacity{};
+		size_t m_used{};
+		size_t m_peak{};
+		std::vector<Overflow> m_overflow;
+		size_t m_overflow_bytes{};
+
+	}; // end class
+}; // end namespace
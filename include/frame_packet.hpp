@@ -0,0 +1,143 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "imgui.h"
+#include "xplor_types.hpp"
+#include "frame_arena.hpp"
+#include "stats.hpp"
+
+namespace Xplor
+{
+	class Material;
+
+	// Everything the renderer needs to issue one draw, captured when the frame is built
+	struct DrawItem {
+		uint64_t sort_key;
+		Material* material; // Kept alive by FramePacket::materials, only bound on the render thread
+		uint32_t VAO;
+		uint32_t element_count;
+		bool indexed;
+		ObjectUniforms uniforms;
+	};
+
+	// Submission order: by material sort key, ties broken by object so the order is stable
+	// no matter which thread recorded the draw
+	inline bool DrawItemLess(const DrawItem& a, const DrawItem& b)
+	{
+		if (a.sort_key != b.sort_key)
+			return a.sort_key < b.sort_key;
+		return a.uniforms.object_id < b.uniforms.object_id;
+	}
+
+	// Draws recorded by one thread, merged into the frame packet once every thread is done
+	struct RenderCommandList {
+		std::vector<DrawItem> draws;
+		std::vector<BoundingBox> debug_boxes;
+	};
+
+	/// <summary>
+	/// Description of one frame built by the simulation thread and consumed by the renderer.
+	/// Nothing in here points back at game objects, so simulation of the next frame can continue
+	/// while the packet is being drawn. Draws do point at their materials: binding one uploads
+	/// its parameters and updates its GL objects, which only the render thread does once a
+	/// material has been drawn. The packet holds a reference to every material it uses and the
+	/// render thread drops them after drawing it, so a material outlives the packets using it
+	/// and is destroyed on the thread owning the context.
+	/// </summary>
+	struct FramePacket {
+		CameraUniforms camera{};
+		glm::vec4 clear_color{};
+		int framebuffer_width{};
+		int framebuffer_height{};
+
+		// The lists live in the packet's own arena. Packets are double buffered by the render thread,
+		// so one arena is being read while the next frame fills the other, and each is only reset
+		// once its packet was drawn.
+		FrameArena arena;
+		std::pmr::vector<DrawItem> draws{ &arena };
+		std::pmr::vector<BoundingBox> debug_boxes{ &arena };
+		std::pmr::vector<std::shared_ptr<Material>> materials{ &arena }; // One per material the draws use
+
+		// Filled by the renderer while drawing the packet, read back once it retired
+		StatCounts render_stats{};
+
+		// Releases of GPU resources this packet may still draw with, run by the thread owning the
+		// context once the packet was drawn
+		std::vector<std::function<void()>> deferred;
+
+		// Deep copy of ImGui's draw data, ImGui reuses its own lists on the next NewFrame
+		ImDrawData ui{};
+		bool has_ui{};
+
+		FramePacket() = default;
+		FramePacket(const FramePacket&) = delete;
+		FramePacket& operator=(const FramePacket&) = delete;
+
+		~FramePacket()
+		{
+			clear();
+		}
+
+		void clear()
+		{
+			// Fresh lists first, the old ones must not point into the arena once it is reset
+			draws = std::pmr::vector<DrawItem>(&arena);
+			debug_boxes = std::pmr::vector<BoundingBox>(&arena);
+			releaseMaterials();
+			arena.reset();
+			releaseUI();
+			render_stats = {};
+		}
+
+		/// <summary>
+		/// Run and drop the deferred releases, called by the render thread once the packet was drawn
+		/// </summary>
+		void runDeferred()
+		{
+			for (auto& command : deferred)
+			{
+				command();
+			}
+			deferred.clear();
+		}
+
+		/// <summary>
+		/// Drop the material references, called by the render thread once the packet was drawn
+		/// </summary>
+		void releaseMaterials()
+		{
+			materials = std::pmr::vector<std::shared_ptr<Material>>(&arena);
+		}
+
+		void captureUI(const ImDrawData* draw_data)
+		{
+			releaseUI();
+			if (!draw_data || !draw_data->Valid)
+				return;
+
+			ui = *draw_data;
+			for (int i = 0; i < ui.CmdListsCount; i++)
+			{
+				ui.CmdLists[i] = draw_data->CmdLists[i]->CloneOutput();
+			}
+			has_ui = true;
+		}
+
+	private:
+		void releaseUI()
+		{
+			if (!has_ui)
+				return;
+
+			for (int i = 0; i < ui.CmdListsCount; i++)
+			{
+				IM_DELETE(ui.CmdLists[i]);
+			}
+			ui = ImDrawData();
+			has_ui = false;
+		}
+	};
+}; // end namespace
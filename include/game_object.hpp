@@ -1,15 +1,29 @@
 #pragma once
 
-#include "matrix_stack.hpp"
+#include "transform_hierarchy.hpp"
 #include "xplor_types.hpp"
 #include "shader.hpp"
+#include "material.hpp"
+#include "frame_packet.hpp"
 #include "geometry.hpp"
+#include "broadphase.hpp"
+#include "loose_octree.hpp"
+#include "activity_set.hpp"
+#include "kinematics.hpp"
+#include "mesh_manager.hpp"
+#include "slot_map.hpp"
+#include "pool_allocator.hpp"
+#include "string_id.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
 #include <stb_image.h>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <array>
 #include <memory>
+#include <algorithm>
+#include <limits>
 
 
 struct ImageData
@@ -30,7 +44,7 @@ namespace Xplor {
 	public:
 		void init();
 		
-		void addTexture(std::string imagePath, ImageFormat format)
+		void addTexture(StringId imagePath, ImageFormat format)
 		{
 			m_texture_paths.push_back({ imagePath, format });
 		}
@@ -41,15 +55,16 @@ namespace Xplor {
 			{
 				auto imagePath = std::get<0>(pair);
 				auto format = std::get<1>(pair);
+				XPLOR_PROFILE_SCOPE("Texture Load");
 
 				ImageData imageBox;
 				stbi_set_flip_vertically_on_load(true); // Align the coordinates
-				std::string fullPath = resources + imagePath;
+				std::string fullPath = RESOURCE_PATH + imagePath.getString();
 				// Fill Variables with image data
 				imageBox.data = stbi_load(fullPath.c_str(), &imageBox.width, &imageBox.height, &imageBox.channels, 0);
 				if (!imageBox.data)
 				{
-					std::cout << "Error: Image failed to load" << std::endl;
+					XPLOR_LOG_ERROR(Render, "Image failed to load: %s", fullPath.c_str());
 				}
 				//--- Texture generation
 				uint32_t texture1;
@@ -74,6 +89,9 @@ namespace Xplor {
 				// Free the image data once the texture has been created
 				stbi_image_free(imageBox.data);
 
+				// Samplers follow the customTextureN naming used by the shaders
+				uint32_t slot = static_cast<uint32_t>(m_textures.size());
+				getMaterial()->setTexture(slot, texture1, "customTexture" + std::to_string(slot + 1));
 				m_textures.push_back(texture1);
 			}
 		}
@@ -81,7 +99,32 @@ namespace Xplor {
 		// Ideally this should support multiple shaders 
 		void addShader(std::shared_ptr<Shader> shader)
 		{
-			m_shader = shader;
+			getMaterial()->setShader(shader);
+		}
+
+		/// <summary>
+		/// Share a material with other objects. Objects using the same material are drawn back to back.
+		/// </summary>
+		/// <param name="material"></param>
+		void setMaterial(std::shared_ptr<Material> material)
+		{
+			m_material = material;
+		}
+
+		/// <summary>
+		/// Get the object's material, creating an empty one if none has been assigned yet
+		/// </summary>
+		/// <returns></returns>
+		const std::shared_ptr<Material>& getMaterial()
+		{
+			if (!m_material)
+				m_material = MakePooled<Material>();
+			return m_material;
+		}
+
+		uint64_t getSortKey() const
+		{
+			return m_material ? m_material->getSortKey() : 0;
 		}
 
 		void addGeometry(float* geometryData, size_t dataSize, unsigned int stepSize, uint32_t indexCount)
@@ -108,68 +151,305 @@ namespace Xplor {
 
 		void initGeometry();
 
-		void initBoundingBoxDraw();
+		/// <summary>
+		/// Share the GPU buffers, mesh and material of an initialised object and copy its default
+		/// transform, motion and lifetime. Used by Prefab and to reset pooled instances for reuse,
+		/// the source has to outlive this object.
+		/// </summary>
+		void initFromPrefab(const std::shared_ptr<const GameObject>& source);
+
+		/// <summary>
+		/// Object this one was instantiated from, null if it owns its resources
+		/// </summary>
+		const std::shared_ptr<const GameObject>& getPrefabSource() const
+		{
+			return m_prefab_source;
+		}
+
+		/// <summary>
+		/// Seconds of simulation after being added to the engine before the object is despawned,
+		/// infinite by default. Read when the object is added.
+		/// </summary>
+		void setTimeToLive(float seconds)
+		{
+			m_time_to_live = seconds;
+		}
+
+		float getTimeToLive() const
+		{
+			return m_time_to_live;
+		}
+
+		/// <summary>
+		/// Despawn the object once its bounds leave the engine's world bounds
+		/// </summary>
+		void setDespawnOutsideWorld(bool despawn)
+		{
+			m_despawn_outside_world = despawn;
+		}
+
+		bool getDespawnOutsideWorld() const
+		{
+			return m_despawn_outside_world;
+		}
 
 		void update(const float delta_time)
 		{
-			glm::vec3 last_position = m_position;
+			// Kept so rendering can interpolate between the last two ticks
+			m_previous_position = m_position;
 			updatePosition(delta_time);
 
-			if (last_position != m_position)
+			if (m_previous_position != m_position)
 			{
-				updateBoundingBox();
-			}			
+				translateBounds();
+				pushTransform();
+				m_bounds_dirty = true;
+			}
+
+			// Nothing left to integrate, stay out of the update loop until something wakes the object
+			if (m_velocity == glm::vec3(0.0f) && m_acceleration == glm::vec3(0.0f))
+			{
+				m_sleeping = true;
+			}
+		}
+
+		/// <summary>
+		/// Copy the kinematic state into slot i of a batch for the SIMD integrator
+		/// </summary>
+		void writeKinematics(KinematicsBatch& batch, size_t i) const
+		{
+			batch.position_x[i] = m_position.x;
+			batch.position_y[i] = m_position.y;
+			batch.position_z[i] = m_position.z;
+			batch.velocity_x[i] = m_velocity.x;
+			batch.velocity_y[i] = m_velocity.y;
+			batch.velocity_z[i] = m_velocity.z;
+			batch.acceleration_x[i] = m_acceleration.x;
+			batch.acceleration_y[i] = m_acceleration.y;
+			batch.acceleration_z[i] = m_acceleration.z;
+			batch.damping[i] = m_damping;
+			batch.half_extent_x[i] = m_bounds_extent.x;
+			batch.half_extent_y[i] = m_bounds_extent.y;
+			batch.half_extent_z[i] = m_bounds_extent.z;
+		}
+
+		/// <summary>
+		/// Take the integrated state and bounds back from slot i, the batched equivalent of update()
+		/// </summary>
+		/// <returns>True if the broadphase proxy needs the new bounds</returns>
+		bool readKinematics(const KinematicsBatch& batch, size_t i)
+		{
+			m_previous_position = m_position;
+			m_position = glm::vec3(batch.position_x[i], batch.position_y[i], batch.position_z[i]);
+			m_velocity = glm::vec3(batch.velocity_x[i], batch.velocity_y[i], batch.velocity_z[i]);
+
+			if (m_previous_position != m_position)
+				pushTransform();
+
+			bool bounds_changed = m_bounds_dirty || m_previous_position != m_position;
+			if (bounds_changed)
+			{
+				// The kernel centres the bounds on the position, the mesh centre may sit elsewhere
+				m_bbox.min = glm::vec3(batch.bounds_min_x[i], batch.bounds_min_y[i], batch.bounds_min_z[i]) + m_bounds_offset;
+				m_bbox.max = glm::vec3(batch.bounds_max_x[i], batch.bounds_max_y[i], batch.bounds_max_z[i]) + m_bounds_offset;
+				m_bounds_dirty = false;
+			}
+
+			if (m_velocity == glm::vec3(0.0f) && m_acceleration == glm::vec3(0.0f))
+			{
+				m_sleeping = true;
+			}
+
+			return bounds_changed;
+		}
+
+		bool isSleeping() const
+		{
+			return m_sleeping;
+		}
+
+		/// <summary>
+		/// Bring a sleeping object back into the simulation from the next tick
+		/// </summary>
+		void wake()
+		{
+			if (!m_sleeping)
+				return;
+
+			m_sleeping = false;
+			if (m_activity)
+				m_activity->wake(m_activity_index);
+		}
+
+		/// <summary>
+		/// Set the activity set the object rejoins when woken
+		/// </summary>
+		void setActivitySet(ActivitySet* activity, uint32_t index)
+		{
+			m_activity = activity;
+			m_activity_index = index;
+			m_sleeping = false;
 		}
 
 		void updatePosition(const float delta_time)
 		{
-			// Transformations
-			glm::vec3 update_velocity = delta_time * m_velocity;
+			// Semi-implicit Euler, the same steps as the batched kernels in kinematics.cpp
+			const float damping = std::max(0.0f, 1.0f - m_damping * delta_time);
+			m_velocity = (m_velocity + m_acceleration * delta_time) * damping;
+			glm::vec3 update_velocity = m_velocity * delta_time;
 			m_position += update_velocity;
 		}
 
+		/// <summary>
+		/// Recompute the world bounds from the mesh's local bounds and the full world matrix.
+		/// Needed whenever rotation, scale, the parent or the mesh change, moving a root only
+		/// needs translateBounds.
+		/// </summary>
 		void updateBoundingBox()
 		{
-			glm::vec3 min = m_position - glm::vec3(0.5f) * m_scale;
-			glm::vec3 max = m_position + glm::vec3(0.5f) * m_scale;
-			m_bbox = { min, max };
+			const glm::mat4 model = computeWorldMatrix();
+			m_bbox = m_local_bounds.transformed(model);
+			m_bounds_offset = m_bbox.getCenter() - m_position;
+			m_bounds_extent = m_bbox.getExtent();
+
+			// Scaling stretches the sphere by the longest axis of the linear part
+			const float max_scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+			m_bounds_radius = m_local_sphere.radius * max_scale;
+		}
 
-			//// old method
-			// Currently this is assuming the object is a cube
-			/*int size = 1.0f;
-			m_bbox.min = m_position - glm::vec3(size / 2.0f);
-			m_bbox.max = m_position + glm::vec3(size / 2.0f);*/
+		/// <summary>
+		/// Move the world bounds with the position, rotation and scale are unchanged
+		/// </summary>
+		void translateBounds()
+		{
+			const glm::vec3 center = m_position + m_bounds_offset;
+			m_bbox = { center - m_bounds_extent, center + m_bounds_extent };
 		}
 
-		void updateModelMatrix()
+		/// <summary>
+		/// Position between the previous and the current tick
+		/// </summary>
+		/// <param name="alpha">0 is the previous tick, 1 the current one</param>
+		glm::vec3 getInterpolatedPosition(float alpha) const
 		{
-			glm::mat4 model = glm::mat4(1.0f);
-			model = glm::translate(model, m_position);
-			if (m_rotation_amount)
-			{
-				model = glm::rotate(model, glm::radians(m_rotation_amount), m_rotation_axis);
-			}
-			m_model_matrix = model;
+			return glm::mix(m_previous_position, m_position, alpha);
 		}
 
-		void draw(glm::mat4 view_matrix, glm::mat4 projection_matrix);
+		/// <summary>
+		/// Translate * rotate * scale relative to the parent
+		/// </summary>
+		glm::mat4 computeLocalMatrix() const
+		{
+			glm::mat4 local = m_rotation_scale;
+			local[3] = glm::vec4(m_position, 1.0f);
+			return local;
+		}
 
-		void drawBoundingBox(const glm::mat4& view_matrix, const glm::mat4& projection_matrix);
+		/// <summary>
+		/// World transform including local changes not yet seen by the hierarchy update
+		/// </summary>
+		glm::mat4 computeWorldMatrix() const
+		{
+			return m_transforms ? m_transforms->evaluateWorld(m_transform) : computeLocalMatrix();
+		}
 
-		void Delete()
+		/// <summary>
+		/// Local to world transform at the given interpolation between ticks. Objects in a hierarchy
+		/// read the world matrix cached by its last update.
+		/// </summary>
+		glm::mat4 computeModelMatrix(float alpha = 1.0f) const
+		{
+			if (m_transforms)
+				return m_transforms->getWorld(m_transform, alpha);
+
+			glm::mat4 model = m_rotation_scale;
+			model[3] = glm::vec4(getInterpolatedPosition(alpha), 1.0f);
+			return model;
+		}
+
+		/// <summary>
+		/// Join a transform hierarchy, the node must have been created with computeLocalMatrix
+		/// </summary>
+		void setTransform(TransformHierarchy* transforms, TransformHierarchy::TransformId transform)
+		{
+			m_transforms = transforms;
+			m_transform = transform;
+		}
+
+		TransformHierarchy::TransformId getTransform() const
+		{
+			return m_transform;
+		}
+
+		/// <summary>
+		/// Refresh the bounds after the transform or the parent changed and let the simulation pick it up
+		/// </summary>
+		void refreshTransform()
+		{
+			updateBoundingBox();
+			m_bounds_dirty = true;
+			wake();
+		}
+
+		void updateModelMatrix(float alpha = 1.0f)
+		{
+			m_model_matrix = computeModelMatrix(alpha);
+		}
+
+		/// <summary>
+		/// Per-draw data streamed to the ObjectBlock uniform block
+		/// </summary>
+		/// <param name="alpha">Interpolation between the previous and the current tick</param>
+		/// <returns></returns>
+		ObjectUniforms getObjectUniforms(float alpha = 1.0f)
 		{
-			if (m_shader)
-				m_shader->Delete();
+			updateModelMatrix(alpha);
+
+			ObjectUniforms uniforms{};
+			uniforms.model = m_model_matrix;
+			uniforms.normal_matrix = glm::mat4(glm::transpose(glm::inverse(glm::mat3(m_model_matrix))));
+			uniforms.object_id = static_cast<int32_t>(m_id);
+			uniforms.material_index = m_material ? static_cast<int32_t>(m_material->getID()) : 0;
+			return uniforms;
+		}
+
+		/// <summary>
+		/// Capture everything needed to draw the object into a frame packet item
+		/// </summary>
+		/// <param name="out_item"></param>
+		/// <param name="alpha">Interpolation between the previous and the current tick</param>
+		/// <returns>False if the object has no geometry or material to draw</returns>
+		bool getDrawItem(DrawItem& out_item, float alpha = 1.0f);
 
-			// Check if these are populated first
-			glDeleteVertexArrays(1, &m_VAO);
-			glDeleteBuffers(1, &m_VBO);
-			glDeleteBuffers(1, &m_EBO);
+		/// <summary>
+		/// Free the GL objects the object created itself. Shaders are shared through the
+		/// ShaderManager and materials free their own buffer, neither is touched here.
+		/// </summary>
+		void Delete()
+		{
+			// The prefab owns the shared resources
+			if (m_prefab_source)
+				return;
+
+			if (m_VAO)
+				glDeleteVertexArrays(1, &m_VAO);
+			if (m_VBO)
+				glDeleteBuffers(1, &m_VBO);
+			if (m_EBO)
+				glDeleteBuffers(1, &m_EBO);
+			if (!m_textures.empty())
+				glDeleteTextures(static_cast<GLsizei>(m_textures.size()), m_textures.data());
+
+			m_VAO = 0;
+			m_VBO = 0;
+			m_EBO = 0;
+			m_textures.clear();
 		}
 
 		void addImpulse(glm::vec3 impulse)
 		{
 			m_velocity += impulse;
+			wake();
 		}
 
 		/// <summary>
@@ -178,14 +458,19 @@ namespace Xplor {
 		/// <param name="pos">Position to place the object in the world.</param>
 		void setPosition(const glm::vec3& position)
 		{
+			// Teleport, do not interpolate from the old position
 			m_position = position;
-			updateBoundingBox();
+			m_previous_position = position;
+			pushTransform(true);
+			refreshTransform();
 		}
 
 		void setScale(const glm::vec3& scale)
 		{
 			m_scale = scale;
-			updateBoundingBox();
+			updateRotationScale();
+			pushTransform();
+			refreshTransform();
 		}
 
 		const BoundingBox& getBoundingBox() const
@@ -193,6 +478,22 @@ namespace Xplor {
 			return m_bbox;
 		}
 
+		/// <summary>
+		/// World bounding sphere, shares its centre with the bounding box
+		/// </summary>
+		BoundingSphere getBoundingSphere() const
+		{
+			return { m_bbox.getCenter(), m_bounds_radius };
+		}
+
+		/// <summary>
+		/// Triangles of the object's geometry for precise picking, null until initGeometry
+		/// </summary>
+		const std::shared_ptr<const Mesh>& getMesh() const
+		{
+			return m_mesh;
+		}
+
 		/// <summary>
 		/// 
 		/// </summary>
@@ -201,6 +502,9 @@ namespace Xplor {
 		{
 			m_rotation_axis = rotAxis;
 			m_rotation_amount = rotAmount;
+			updateRotationScale();
+			pushTransform();
+			refreshTransform();
 		}
 
 		const std::vector<uint32_t> getTextures() const
@@ -210,7 +514,40 @@ namespace Xplor {
 
 		const std::shared_ptr<Shader> getShader() const
 		{
-			return m_shader;
+			return m_material ? m_material->getShader() : nullptr;
+		}
+
+		uint32_t getBroadphaseProxy() const
+		{
+			return m_broadphase_proxy;
+		}
+
+		void setBroadphaseProxy(uint32_t proxy)
+		{
+			m_broadphase_proxy = proxy;
+		}
+
+		uint32_t getOctreeProxy() const
+		{
+			return m_octree_proxy;
+		}
+
+		void setOctreeProxy(uint32_t proxy)
+		{
+			m_octree_proxy = proxy;
+		}
+
+		/// <summary>
+		/// Handle of the object in the engine's object storage, invalid until it is added
+		/// </summary>
+		Handle getHandle() const
+		{
+			return m_handle;
+		}
+
+		void setHandle(Handle handle)
+		{
+			m_handle = handle;
 		}
 
 		void setID(uint32_t id)
@@ -223,12 +560,17 @@ namespace Xplor {
 			return m_id;
 		}
 
-		const std::string& getName()
+		const std::string& getName() const
+		{
+			return m_name.getString();
+		}
+
+		StringId getNameId() const
 		{
 			return m_name;
 		}
 
-		void setName(std::string name)
+		void setName(StringId name)
 		{
 			m_name = name;
 		}
@@ -236,6 +578,21 @@ namespace Xplor {
 		void setVelocity(const glm::vec3& velocity)
 		{
 			m_velocity = velocity;
+			wake();
+		}
+
+		void setAcceleration(const glm::vec3& acceleration)
+		{
+			m_acceleration = acceleration;
+			wake();
+		}
+
+		/// <summary>
+		/// Fraction of the velocity lost per second
+		/// </summary>
+		void setDamping(float damping)
+		{
+			m_damping = damping;
 		}
 
 		json Serialize() const
@@ -245,12 +602,13 @@ namespace Xplor {
 				{ "id", m_id },
 				{ "name", m_name },
 				{ "position", {m_position.x, m_position.y, m_position.z}},
-				{ "geometry", m_geometry.Serialize()},
-				{ "shader", m_shader->Serialize()},
+				{ "geometry", getResourceOwner().m_geometry.Serialize()},
+				{ "shader", getShader()->Serialize()},
+				{ "material", m_material->Serialize()},
 				{ "VAO", m_VAO},
 				{ "VBO", m_VBO},
 				{ "EBO", m_EBO},
-				{ "texture paths", m_texture_paths}
+				{ "texture paths", getResourceOwner().m_texture_paths}
 			};
 		}
 
@@ -258,9 +616,10 @@ namespace Xplor {
 		{
 			m_object_type = j.at("type").get<Xplor::GameObjectType>();
 			m_id = j.at("id").get<uint32_t>();
-			m_name = j.at("name").get<std::string>();
+			m_name = j.at("name").get<StringId>();
 			auto jPosition = j.at("position").get<std::vector<float>>();
 			m_position = glm::vec3(jPosition[0], jPosition[1], jPosition[2]);
+			m_previous_position = m_position;
 
 			m_geometry.Deserialize(j.at("geometry"));
 			initGeometry();
@@ -268,9 +627,23 @@ namespace Xplor {
 			m_texture_paths = j.at("texture paths");
 			initTextures();
 
-			m_shader = std::make_shared<Xplor::Shader>();
-			m_shader->Deserialize(j.at("shader"));
-			m_shader->init();
+			auto shader = std::make_shared<Xplor::Shader>();
+			shader->Deserialize(j.at("shader"));
+			shader->init();
+			getMaterial()->setShader(shader);
+
+			if (j.contains("material"))
+			{
+				m_material->Deserialize(j.at("material"));
+			}
+			else if (j.at("shader").contains("uniform ints"))
+			{
+				// Older scenes stored sampler ints on the shader itself
+				for (const auto& uniform : j.at("shader").at("uniform ints"))
+				{
+					m_material->setInt(uniform[0].get<std::string>(), uniform[1].get<int>());
+				}
+			}
 
 			m_VAO = j.at("VAO").get<uint32_t>();
 			m_VBO = j.at("VBO").get<uint32_t>();
@@ -292,32 +665,79 @@ namespace Xplor {
 	protected:
 		// Unique identifier for object
 		uint32_t m_id{};
+		Handle m_handle;
 		// Optional identifier (makes searching for this object easier)
-		std::string m_name{};
-		const std::string resources = "..//resources//";
+		StringId m_name{};
+		static constexpr const char* RESOURCE_PATH = "..//resources//";
 		std::vector<uint32_t> m_textures{};
-		std::vector<std::tuple<std::string, ImageFormat>> m_texture_paths;
-		std::shared_ptr<Shader> m_shader{};
+		std::vector<std::tuple<StringId, ImageFormat>> m_texture_paths;
+		std::shared_ptr<Material> m_material{};
 		uint32_t m_VBO{}, m_VAO{}, m_EBO{};
 		
 		size_t m_index_count{}; // Number of indices needed to be rendered
+		// Object whose geometry and GPU buffers this one shares, null if it owns them
+		std::shared_ptr<const GameObject> m_prefab_source;
+
+		const GameObject& getResourceOwner() const
+		{
+			return m_prefab_source ? *m_prefab_source : *this;
+		}
 		glm::vec3 m_position{};
-		glm::vec3 m_last_position{}; // Used with bounding box drawing
+		glm::vec3 m_previous_position{}; // Position at the previous simulation tick
 		glm::vec3 m_velocity{};
+		glm::vec3 m_acceleration{};
+		float m_damping{};
 		glm::vec3 m_scale{1.0f};
+		float m_time_to_live{ std::numeric_limits<float>::infinity() };
+		bool m_despawn_outside_world{};
 
 		glm::vec3 m_rotation_axis{};
 		float m_rotation_amount{};
 		
 		Xplor::GameObjectType m_object_type{ Xplor::GameObjectType::GameObject };
 		Geometry m_geometry;
+		std::shared_ptr<const Mesh> m_mesh; // Shared with every object using the same geometry
 		// Axis Alinged Bounding Box for Collisions
 		BoundingBox m_bbox;
-		// Bounding box VAO and VBO
-		GLuint m_bboxVAO = 0, m_bboxVBO = 0, m_bboxEBO = 0;
+		// Until a mesh is assigned objects are treated as unit cubes
+		BoundingBox m_local_bounds{ glm::vec3(-0.5f), glm::vec3(0.5f) };
+		BoundingSphere m_local_sphere{ glm::vec3(0.0f), 0.8660254f };
+		glm::vec3 m_bounds_offset{};    // World bounds centre relative to the position
+		glm::vec3 m_bounds_extent{0.5f}; // World bounds half size
+		float m_bounds_radius{0.8660254f};
+		bool m_bounds_dirty{}; // Bounds changed since they were last handed to the broadphase
+		uint32_t m_broadphase_proxy{ SweepAndPrune::INVALID_PROXY };
+		uint32_t m_octree_proxy{ LooseOctree::INVALID_PROXY };
+		// Sleeping objects are skipped by the update loop
+		bool m_sleeping{};
+		ActivitySet* m_activity{};
+		uint32_t m_activity_index{};
 
-		// Want a matrix stack instead of all of these
 		glm::mat4 m_model_matrix{1.0f};
+		// Linear part of the local matrix, only rebuilt when rotation or scale change
+		glm::mat4 m_rotation_scale{1.0f};
+		TransformHierarchy* m_transforms{};
+		TransformHierarchy::TransformId m_transform{ TransformHierarchy::INVALID_TRANSFORM };
+
+		void updateRotationScale()
+		{
+			m_rotation_scale = glm::mat4(1.0f);
+			if (m_rotation_amount)
+			{
+				m_rotation_scale = glm::rotate(m_rotation_scale, glm::radians(m_rotation_amount), m_rotation_axis);
+			}
+			m_rotation_scale = glm::scale(m_rotation_scale, m_scale);
+		}
+
+		/// <summary>
+		/// Hand the local matrix to the hierarchy, which recomputes the world matrix on its next update
+		/// </summary>
+		/// <param name="snap">Teleport, do not interpolate</param>
+		void pushTransform(bool snap = false)
+		{
+			if (m_transforms)
+				m_transforms->setLocal(m_transform, computeLocalMatrix(), snap);
+		}
 
 	private:
 
@@ -335,5 +755,10 @@ namespace Xplor {
 
 	};
 
+	/// <summary>
+	/// Empty object of the given type, allocated from the pool for that type
+	/// </summary>
+	std::shared_ptr<GameObject> CreateGameObject(GameObjectType type);
+
 }; // end namespace
 
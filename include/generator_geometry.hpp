@@ -127,6 +127,33 @@ public:
         return data;
     }
 
+    /// <summary>
+    /// The 12 edges of a box as pairs of line vertices, for drawing with GL_LINES
+    /// </summary>
+    static std::array<float, 72> GenerateBoundingBoxLines(const glm::vec3& min, const glm::vec3& max)
+    {
+        std::array<float, 72> data{
+            // Bottom face
+            min.x, min.y, min.z,   max.x, min.y, min.z,
+            max.x, min.y, min.z,   max.x, min.y, max.z,
+            max.x, min.y, max.z,   min.x, min.y, max.z,
+            min.x, min.y, max.z,   min.x, min.y, min.z,
+
+            // Top face
+            min.x, max.y, min.z,   max.x, max.y, min.z,
+            max.x, max.y, min.z,   max.x, max.y, max.z,
+            max.x, max.y, max.z,   min.x, max.y, max.z,
+            min.x, max.y, max.z,   min.x, max.y, min.z,
+
+            // Connect bottom and top faces
+            min.x, min.y, min.z,   min.x, max.y, min.z,
+            max.x, min.y, min.z,   max.x, max.y, min.z,
+            max.x, min.y, max.z,   max.x, max.y, max.z,
+            min.x, min.y, max.z,   min.x, max.y, max.z
+        };
+        return data;
+    }
+
     //static std::vector<unsigned int> GenerateBoundingBoxIndices()
     //{
     //    return {
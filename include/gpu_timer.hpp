@@ -0,0 +1,92 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+namespace Xplor
+{
+	enum class GpuPass : uint32_t
+	{
+		Scene = 0,
+		BoundingBoxes,
+		UI,
+		Count
+	};
+
+	/// <summary>
+	/// GPU time of each render pass from GL_TIMESTAMP queries written before and after the pass.
+	/// Every frame uses its own set of queries out of a ring of FRAMES_IN_FLIGHT, and a set is only
+	/// read when it comes around again, so the results are a few frames old but reading them never
+	/// waits on the GPU. A frame whose results are still not ready by then is skipped.
+	/// Recording methods must be called on the thread owning the OpenGL context, the history may
+	/// be read from any thread.
+	/// </summary>
+	class GpuTimer
+	{
+	public:
+		static constexpr uint32_t FRAMES_IN_FLIGHT = 4;
+		static constexpr uint32_t HISTORY_SIZE = 240;
+		static constexpr uint32_t PASS_COUNT = static_cast<uint32_t>(GpuPass::Count);
+
+		using History = std::array<float, HISTORY_SIZE>;
+
+		/// <summary>
+		/// Create the queries. Requires a current OpenGL context.
+		/// </summary>
+		void init();
+
+		void destroy();
+
+		/// <summary>
+		/// Collect the results of the frame that last used this frame's queries
+		/// </summary>
+		void beginFrame();
+
+		void beginPass(GpuPass pass);
+
+		void endPass(GpuPass pass);
+
+		void endFrame();
+
+		/// <summary>
+		/// Milliseconds of the last frames for one pass, oldest first starting at out_offset
+		/// </summary>
+		void getHistory(GpuPass pass, History& out_history, uint32_t& out_offset) const;
+
+		/// <summary>
+		/// Milliseconds of the newest frame with results, all passes together
+		/// </summary>
+		float getLatestFrameMs() const;
+
+		/// <summary>
+		/// Frames whose results were not ready when their queries were needed again
+		/// </summary>
+		uint64_t getSkippedFrameCount() const;
+
+		static const char* GetPassName(GpuPass pass);
+
+	private:
+		struct FrameQueries {
+			std::array<GLuint, PASS_COUNT * 2> queries{}; // Start and end timestamp per pass
+			std::array<bool, PASS_COUNT> issued{};
+			GLuint last_query{};
+			bool pending{};
+			int64_t cpu_offset{}; // Profiler clock minus GPU clock when the frame started
+		};
+
+		void readResults(FrameQueries& frame);
+
+		std::array<FrameQueries, FRAMES_IN_FLIGHT> m_frames{};
+		uint32_t m_frame{};
+		bool m_initialized{};
+
+		mutable std::mutex m_history_mutex;
+		std::array<History, PASS_COUNT> m_history{};
+		uint32_t m_history_head{}; // Next entry to write, also the oldest one
+		float m_latest_frame_ms{};
+		uint64_t m_skipped_frames{};
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "manager.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Counts outstanding jobs, wait on it to know when a group of jobs is finished
+	/// </summary>
+	struct JobCounter {
+		std::atomic<uint32_t> remaining{ 0 };
+
+		bool isDone() const
+		{
+			return remaining.load(std::memory_order_acquire) == 0;
+		}
+	};
+
+	/// <summary>
+	/// Pool of worker threads executing short jobs. Threads waiting on a counter help run
+	/// queued jobs instead of sleeping, so waiting from inside a job can not deadlock.
+	/// </summary>
+	class JobSystem : public Manager<JobSystem>
+	{
+	public:
+		JobSystem();
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/// <summary>
+		/// Queue a job, the counter is incremented now and decremented once the job finished
+		/// </summary>
+		void run(std::function<void()> job, JobCounter* counter = nullptr);
+
+		/// <summary>
+		/// Block until the counter reaches zero, executing other jobs in the meantime
+		/// </summary>
+		void wait(const JobCounter& counter);
+
+		/// <summary>
+		/// Split [0, count) into batches of at least min_batch items and run them in parallel.
+		/// Returns once every batch is done. The calling thread takes part in the work.
+		/// </summary>
+		/// <param name="job">Called as job(begin, end, thread_index) with the batch range and the index of the executing thread</param>
+		template<typename Function>
+		void parallelFor(size_t count, size_t min_batch, Function&& job)
+		{
+			// Called through a plain function pointer, wrapping the callable in a std::function would
+			// allocate whenever it captures more than a couple of references
+			using Callable = std::remove_reference_t<Function>;
+			void* context = const_cast<void*>(static_cast<const void*>(std::addressof(job)));
+			parallelForRanges(count, min_batch, [](void* callable, size_t begin, size_t end, uint32_t thread_index) {
+				(*static_cast<Callable*>(callable))(begin, end, thread_index);
+			}, context);
+		}
+
+		/// <summary>
+		/// Execute one queued job of the group on the calling thread, if there is any
+		/// </summary>
+		/// <param name="group">Group set with JobGroupScope, nullptr for any job</param>
+		/// <returns>False when no job of the group was queued</returns>
+		bool runPendingJob(const void* group)
+		{
+			return tryRunOne(group);
+		}
+
+		/// <summary>
+		/// Number of threads that may execute jobs, including the main thread
+		/// </summary>
+		uint32_t getThreadCount() const
+		{
+			return static_cast<uint32_t>(m_workers.size()) + 1;
+		}
+
+		/// <summary>
+		/// Index of the calling thread, 0 for any thread that is not a worker
+		/// </summary>
+		static uint32_t GetThreadIndex();
+
+		/// <summary>
+		/// Group that jobs queued by the calling thread are tagged with. A job runs with the group
+		/// it was tagged with, so the jobs it queues in turn belong to the same group.
+		/// </summary>
+		static const void* GetGroup();
+		static void SetGroup(const void* group);
+
+	private:
+		struct Job {
+			std::function<void()> function;
+			JobCounter* counter;
+			const void* group;
+		};
+
+		using RangeFunction = void (*)(void* context, size_t begin, size_t end, uint32_t thread_index);
+
+		// Batches are described on the caller's stack, which bounds how many there can be
+		static constexpr size_t MAX_PARALLEL_BATCHES = 64;
+
+		void parallelForRanges(size_t count, size_t min_batch, RangeFunction function, void* context);
+
+		void workerMain(uint32_t thread_index);
+		bool tryRunOne(const void* group);
+		void execute(Job& job);
+
+		std::vector<std::thread> m_workers;
+		// Queue blocks are recycled instead of going back to the heap, jobs are queued every frame
+		std::pmr::unsynchronized_pool_resource m_queue_memory;
+		std::pmr::deque<Job> m_queue{ &m_queue_memory };
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stop{};
+
+	}; // end class
+
+	/// <summary>
+	/// Tags the jobs queued by the calling thread with a group until the scope ends
+	/// </summary>
+	class JobGroupScope
+	{
+	public:
+		explicit JobGroupScope(const void* group)
+			: m_previous(JobSystem::GetGroup())
+		{
+			JobSystem::SetGroup(group);
+		}
+
+		~JobGroupScope()
+		{
+			JobSystem::SetGroup(m_previous);
+		}
+
+		JobGroupScope(const JobGroupScope&) = delete;
+		JobGroupScope& operator=(const JobGroupScope&) = delete;
+
+	private:
+		const void* m_previous;
+
+	}; // end class
+}; // end namespace
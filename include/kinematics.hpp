@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "simd.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Raw component arrays of a KinematicsBatch handed to the kernels. The AVX kernel lives in a
+	/// translation unit compiled for AVX and must not instantiate any shared inline code such as
+	/// std::vector members, the linker could pick that copy for the rest of the program.
+	/// </summary>
+	struct KinematicsStreams {
+		float* position_x;
+		float* position_y;
+		float* position_z;
+		float* velocity_x;
+		float* velocity_y;
+		float* velocity_z;
+		const float* acceleration_x;
+		const float* acceleration_y;
+		const float* acceleration_z;
+		const float* damping;
+		const float* half_extent_x;
+		const float* half_extent_y;
+		const float* half_extent_z;
+		float* bounds_min_x;
+		float* bounds_min_y;
+		float* bounds_min_z;
+		float* bounds_max_x;
+		float* bounds_max_y;
+		float* bounds_max_z;
+	};
+
+	/// <summary>
+	/// Kinematic state of a batch of objects, one packed array per component so the
+	/// integration kernels load 4 or 8 objects with a single instruction.
+	/// </summary>
+	struct KinematicsBatch {
+		std::vector<float> position_x, position_y, position_z;
+		std::vector<float> velocity_x, velocity_y, velocity_z;
+		std::vector<float> acceleration_x, acceleration_y, acceleration_z;
+		std::vector<float> damping; // Fraction of velocity lost per second
+		std::vector<float> half_extent_x, half_extent_y, half_extent_z;
+		// Written by the integration
+		std::vector<float> bounds_min_x, bounds_min_y, bounds_min_z;
+		std::vector<float> bounds_max_x, bounds_max_y, bounds_max_z;
+
+		void resize(size_t count);
+
+		KinematicsStreams getStreams();
+
+		size_t size() const
+		{
+			return position_x.size();
+		}
+	};
+
+	struct KinematicsBenchmarkResult {
+		SimdLevel level;
+		float objects_per_ms;
+		float max_error; // Largest position difference to the scalar kernel
+	};
+
+	/// <summary>
+	/// Semi-implicit Euler step for the objects in [begin, end), matching GameObject::updatePosition:
+	/// velocity += acceleration * dt, velocity *= max(0, 1 - damping * dt), position += velocity * dt.
+	/// The bounds are recomputed from the new position and half extents in the same pass.
+	/// Distinct ranges may be integrated from several threads.
+	/// </summary>
+	void IntegrateKinematics(KinematicsBatch& batch, float delta_time, size_t begin, size_t end);
+
+	/// <summary>
+	/// Time every supported kernel on a synthetic batch and compare its results against the scalar kernel
+	/// </summary>
+	/// <param name="count">Objects in the batch</param>
+	/// <param name="iterations">Integration steps timed per kernel</param>
+	std::vector<KinematicsBenchmarkResult> BenchmarkKinematics(size_t count, uint32_t iterations);
+
+	namespace Detail
+	{
+		void IntegrateKinematicsScalar(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end);
+#if XPLOR_SIMD_X86
+		void IntegrateKinematicsSSE(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end);
+		void IntegrateKinematicsAVX(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end);
+#endif
+	}
+}; // end namespace
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+// Messages below XPLOR_LOG_LEVEL are removed by the preprocessor, arguments included.
+// 0 trace, 1 debug, 2 info, 3 warning, 4 error, 5 nothing
+#ifndef XPLOR_LOG_LEVEL
+#ifdef NDEBUG
+#define XPLOR_LOG_LEVEL 2
+#else
+#define XPLOR_LOG_LEVEL 1
+#endif
+#endif
+
+namespace Xplor
+{
+	enum class LogLevel : uint8_t
+	{
+		Trace = 0,
+		Debug = 1,
+		Info = 2,
+		Warning = 3,
+		Error = 4
+	};
+
+	enum class LogCategory : uint8_t
+	{
+		Core = 0,
+		Render,
+		Shader,
+		Scene,
+		Physics,
+		Input,
+		Count
+	};
+
+	/// <summary>
+	/// Asynchronous logger. Callers format into a slot of a fixed ring buffer without taking a
+	/// lock and a background thread writes the slots out, so logging from the simulation or
+	/// the render loop never waits on the console. When the ring is full the message is dropped
+	/// and counted instead of blocking. Use the XPLOR_LOG_* macros rather than calling write.
+	/// </summary>
+	class Log
+	{
+	public:
+		static constexpr uint32_t RING_SIZE = 1024;      // Slots, power of two
+		static constexpr uint32_t MESSAGE_SIZE = 240;    // Longer messages are truncated
+
+		/// <summary>
+		/// printf style message, the flush thread is started by the first call
+		/// </summary>
+#if defined(__GNUC__)
+		__attribute__((format(printf, 3, 4)))
+#endif
+		static void write(LogLevel level, LogCategory category, const char* format, ...);
+
+		/// <summary>
+		/// Runtime threshold on top of the compile time one
+		/// </summary>
+		static void setLevel(LogLevel level);
+
+		static void setCategoryEnabled(LogCategory category, bool enabled);
+
+		/// <summary>
+		/// Write out everything queued so far before returning, e.g. before a crash is expected
+		/// </summary>
+		static void flush();
+
+		/// <summary>
+		/// Messages lost because the ring was full
+		/// </summary>
+		static uint64_t getDroppedCount();
+
+		static const char* getCategoryName(LogCategory category);
+
+	}; // end class
+}; // end namespace
+
+#if XPLOR_LOG_LEVEL <= 0
+#define XPLOR_LOG_TRACE(category, ...) Xplor::Log::write(Xplor::LogLevel::Trace, Xplor::LogCategory::category, __VA_ARGS__)
+#else
+#define XPLOR_LOG_TRACE(category, ...) ((void)0)
+#endif
+
+#if XPLOR_LOG_LEVEL <= 1
+#define XPLOR_LOG_DEBUG(category, ...) Xplor::Log::write(Xplor::LogLevel::Debug, Xplor::LogCategory::category, __VA_ARGS__)
+#else
+#define XPLOR_LOG_DEBUG(category, ...) ((void)0)
+#endif
+
+#if XPLOR_LOG_LEVEL <= 2
+#define XPLOR_LOG_INFO(category, ...) Xplor::Log::write(Xplor::LogLevel::Info, Xplor::LogCategory::category, __VA_ARGS__)
+#else
+#define XPLOR_LOG_INFO(category, ...) ((void)0)
+#endif
+
+#if XPLOR_LOG_LEVEL <= 3
+#define XPLOR_LOG_WARNING(category, ...) Xplor::Log::write(Xplor::LogLevel::Warning, Xplor::LogCategory::category, __VA_ARGS__)
+#else
+#define XPLOR_LOG_WARNING(category, ...) ((void)0)
+#endif
+
+#if XPLOR_LOG_LEVEL <= 4
+#define XPLOR_LOG_ERROR(category, ...) Xplor::Log::write(Xplor::LogLevel::Error, Xplor::LogCategory::category, __VA_ARGS__)
+#else
+#define XPLOR_LOG_ERROR(category, ...) ((void)0)
+#endif
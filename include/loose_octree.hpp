@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include "xplor_types.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Loose octree over axis aligned bounding boxes for region and nearest neighbour queries.
+	/// Every node's bounds are doubled, so a box is stored at the depth matching its size in the
+	/// cell holding its centre and never straddles a boundary. Nodes are found through a hash of
+	/// (depth, cell), which makes moving a box O(1): only the target cell is looked up, and a box
+	/// that stays in its cell just has its bounds replaced. Boxes with their centre outside the
+	/// root cube are kept in the root.
+	/// Queries write user data into caller buffers and never allocate, so they are safe to run
+	/// from several threads at once as long as nothing is modified meanwhile.
+	/// </summary>
+	class LooseOctree
+	{
+	public:
+		static constexpr uint32_t INVALID_PROXY = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t MAX_DEPTH_LIMIT = 16;
+
+		/// <param name="center">Centre of the root cube</param>
+		/// <param name="half_size">Half the side length of the root cube</param>
+		/// <param name="max_depth">Deepest level, its cells are 2 * half_size / 2^max_depth wide</param>
+		explicit LooseOctree(const glm::vec3& center = glm::vec3(0.0f), float half_size = 2048.0f, uint32_t max_depth = 8);
+
+		/// <summary>
+		/// Insert a box
+		/// </summary>
+		/// <param name="user_data">Written to the query results, e.g. an object index</param>
+		/// <returns>Proxy used to move or remove the box</returns>
+		uint32_t createProxy(const BoundingBox& bounds, uint32_t user_data);
+
+		void destroyProxy(uint32_t proxy);
+
+		/// <summary>
+		/// Move a box, cheap when it stays within its cell
+		/// </summary>
+		void updateProxy(uint32_t proxy, const BoundingBox& bounds);
+
+		/// <summary>
+		/// Remove every proxy and node but the root
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Boxes overlapping box
+		/// </summary>
+		/// <returns>Number of matches, only the first capacity are written to out_user_data</returns>
+		size_t queryBox(const BoundingBox& box, uint32_t* out_user_data, size_t capacity) const;
+
+		/// <summary>
+		/// Boxes touching the sphere at center
+		/// </summary>
+		/// <returns>Number of matches, only the first capacity are written to out_user_data</returns>
+		size_t queryRadius(const glm::vec3& center, float radius, uint32_t* out_user_data, size_t capacity) const;
+
+		/// <summary>
+		/// The k boxes closest to point, nearest first. Distances are to the box surface, 0 inside.
+		/// </summary>
+		/// <param name="out_distances">Optional, k entries</param>
+		/// <returns>Number of boxes found, at most k</returns>
+		size_t queryNearest(const glm::vec3& point, size_t k, uint32_t* out_user_data, float* out_distances = nullptr) const;
+
+		size_t getProxyCount() const
+		{
+			return m_proxies.size() - m_free_proxies.size();
+		}
+
+		size_t getNodeCount() const
+		{
+			return m_nodes.size() - m_free_nodes.size();
+		}
+
+	private:
+		static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+		struct Node {
+			float center[3];
+			float half_size;          // Half the cell, the loose bounds extend twice as far
+			uint32_t children[8];
+			uint32_t parent;
+			uint32_t first_proxy;     // Head of the proxies stored here
+			uint32_t proxy_count;
+			uint32_t child_count;
+			uint64_t key;
+		};
+
+		struct Proxy {
+			BoundingBox bounds;
+			uint32_t user_data;
+			uint32_t node;            // NONE for free proxies
+			uint32_t next;
+			uint32_t prev;
+		};
+
+		static uint64_t NodeKey(uint32_t depth, uint32_t x, uint32_t y, uint32_t z)
+		{
+			return (static_cast<uint64_t>(depth) << 48) | (static_cast<uint64_t>(x) << 32) | (static_cast<uint64_t>(y) << 16) | z;
+		}
+
+		uint64_t locate(const BoundingBox& bounds) const;
+		uint32_t findOrCreateNode(uint64_t key);
+		void link(uint32_t proxy, uint32_t node);
+		void unlink(uint32_t proxy);
+		void prune(uint32_t node);
+
+		template<typename NodeTest, typename ProxyTest>
+		size_t query(NodeTest&& node_test, ProxyTest&& proxy_test, uint32_t* out_user_data, size_t capacity) const;
+
+		glm::vec3 m_min;
+		float m_size;
+		uint32_t m_max_depth;
+
+		std::vector<Node> m_nodes; // The root is node 0
+		std::vector<uint32_t> m_free_nodes;
+		// Nodes come and go as boxes move between cells, the pool recycles the map's entries
+		std::pmr::unsynchronized_pool_resource m_lookup_memory;
+		std::pmr::unordered_map<uint64_t, uint32_t> m_node_lookup{ &m_lookup_memory };
+
+		std::vector<Proxy> m_proxies;
+		std::vector<uint32_t> m_free_proxies;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "shader.hpp"
+#include "xplor_types.hpp"
+#include "string_id.hpp"
+#include "stats.hpp"
+
+namespace Xplor
+{
+	enum class MaterialParameterType
+	{
+		Int = 0,
+		Float = 1,
+		Vec2 = 2,
+		Vec3 = 3,
+		Vec4 = 4,
+		Mat4 = 5
+	};
+
+	struct MaterialParameter
+	{
+		StringId name;
+		MaterialParameterType type;
+		uint32_t offset; // Byte offset of the value in the material's own storage
+		GLint location{ -1 }; // Location in the default uniform block, -1 if the parameter lives in MaterialBlock
+		GLint block_offset{ -1 }; // Offset inside MaterialBlock as laid out by the program, -1 outside the block
+	};
+
+	struct MaterialTexture
+	{
+		uint32_t slot;
+		uint32_t texture;
+	};
+
+	/// <summary>
+	/// Typed shader parameters and texture slots that can be shared across game objects.
+	/// Values are stored by name; which ones live in the program's "uniform MaterialBlock" and
+	/// at which offsets is read back from the linked program, so the block can declare its
+	/// members in any order. The block is uploaded to the material's own uniform buffer, the
+	/// rest (samplers included) are sent as plain uniforms. Nothing is uploaded unless the
+	/// material was changed or another material used the program.
+	/// Parameters are set while an object is being set up; once a frame packet draws the material
+	/// its GL state belongs to the render thread, which binds it and finally destroys it.
+	/// </summary>
+	class Material : public std::enable_shared_from_this<Material>
+	{
+	public:
+		static constexpr const char* BLOCK_NAME = "MaterialBlock";
+		static constexpr GLuint BLOCK_BINDING = static_cast<GLuint>(UniformBinding::Material);
+
+		Material();
+
+		explicit Material(std::shared_ptr<Shader> shader);
+
+		~Material();
+
+		Material(const Material&) = delete;
+		Material& operator=(const Material&) = delete;
+
+		void setShader(std::shared_ptr<Shader> shader);
+
+		const std::shared_ptr<Shader>& getShader() const
+		{
+			return m_shader;
+		}
+
+		void setInt(StringId name, int value);
+		void setFloat(StringId name, float value);
+		void setVec2(StringId name, const glm::vec2& value);
+		void setVec3(StringId name, const glm::vec3& value);
+		void setVec4(StringId name, const glm::vec4& value);
+		void setMat4(StringId name, const glm::mat4& value);
+
+		/// <summary>
+		/// Bind a texture to a texture unit when the material is used
+		/// </summary>
+		/// <param name="slot">Texture unit offset from GL_TEXTURE0</param>
+		/// <param name="texture">OpenGL texture name</param>
+		/// <param name="sampler_name">Optional sampler uniform that will be pointed at the slot</param>
+		void setTexture(uint32_t slot, uint32_t texture, StringId sampler_name = {});
+
+		const std::vector<MaterialTexture>& getTextures() const
+		{
+			return m_textures;
+		}
+
+		/// <summary>
+		/// Use the material's program, bind its textures and upload parameters if needed
+		/// </summary>
+		/// <param name="stats">Counts of the frame being drawn</param>
+		void bind(StatCounts& stats);
+
+		void unbind() const;
+
+		void markDirty()
+		{
+			m_dirty = true;
+		}
+
+		uint32_t getID() const
+		{
+			return m_id;
+		}
+
+		/// <summary>
+		/// Key used to group draws by program first and material second
+		/// </summary>
+		uint64_t getSortKey() const;
+
+		json Serialize() const;
+
+		void Deserialize(const json& j);
+
+	private:
+		void setParameter(StringId name, MaterialParameterType type, const void* value);
+		void resolveLocations();
+		void upload(StatCounts& stats);
+
+		std::shared_ptr<Shader> m_shader{};
+		std::vector<MaterialParameter> m_parameters{};
+		std::vector<uint8_t> m_values{}; // Parameter values, packed in the order they were first set
+		std::vector<uint8_t> m_block{}; // Staging copy of MaterialBlock in the program's layout
+		std::vector<MaterialTexture> m_textures{};
+
+		uint32_t m_id{};
+		bool m_dirty{ true }; // Block contents changed since the last upload
+		bool m_locations_resolved{ false };
+		GLuint m_block_index{ GL_INVALID_INDEX };
+		GLuint m_ubo{};
+
+		static uint32_t s_next_id;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "geometry.hpp"
+#include "scene_bvh.hpp"
+#include "xplor_types.hpp"
+
+namespace Xplor
+{
+	struct MeshHit {
+		uint32_t triangle;
+		float t;                 // Distance along the ray direction the mesh was tested with
+		glm::vec3 barycentrics;  // Weights of the triangle's three vertices at the hit point
+	};
+
+	/// <summary>
+	/// CPU side copy of a mesh's triangles with a triangle BVH for precise ray queries.
+	/// Built once per unique mesh through MeshManager and shared by every object drawing it.
+	/// </summary>
+	class Mesh
+	{
+	public:
+		/// <summary>
+		/// Extract the triangles from interleaved vertex data, positions are the first three floats of each vertex
+		/// </summary>
+		explicit Mesh(const Geometry& geometry);
+
+		/// <summary>
+		/// Closest triangle hit by a ray in the mesh's local space. Uses a watertight ray/triangle
+		/// test, so rays through shared edges and vertices never slip between triangles.
+		/// </summary>
+		/// <param name="max_t">Hits further along the ray are ignored</param>
+		bool intersect(const Ray& ray, float max_t, MeshHit& out_hit) const;
+
+		/// <summary>
+		/// True if the geometry yields exactly this mesh's positions and triangles
+		/// </summary>
+		bool matches(const Geometry& geometry) const;
+
+		const BoundingBox& getLocalBounds() const
+		{
+			return m_local_bounds;
+		}
+
+		/// <summary>
+		/// Sphere around the vertices, centred on the local bounds
+		/// </summary>
+		const BoundingSphere& getLocalSphere() const
+		{
+			return m_local_sphere;
+		}
+
+		size_t getTriangleCount() const
+		{
+			return m_indices.size() / 3;
+		}
+
+		const glm::vec3& getVertex(uint32_t triangle, uint32_t corner) const
+		{
+			return m_positions[m_indices[triangle * 3 + corner]];
+		}
+
+	private:
+		std::vector<glm::vec3> m_positions;
+		std::vector<uint32_t> m_indices; // Three per triangle
+		BoundingBox m_local_bounds{};
+		BoundingSphere m_local_sphere{};
+		SceneBVH m_bvh; // Over the triangle bounds
+
+	}; // end class
+}; // end namespace
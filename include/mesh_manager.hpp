@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "manager.hpp"
+#include "mesh.hpp"
+
+namespace Xplor
+{
+	class MeshManager : public Manager<MeshManager>
+	{
+		// Manager for CPU side meshes so each unique mesh builds its triangle BVH once and is shared
+
+	public:
+		/// <summary>
+		/// Mesh for the geometry, built on first use. Geometry with identical contents shares one mesh.
+		/// </summary>
+		std::shared_ptr<const Mesh> getMesh(const Geometry& geometry);
+
+		size_t getMeshCount() const;
+
+	private:
+		static uint64_t hashGeometry(const Geometry& geometry);
+
+		mutable std::mutex m_mutex;
+		// Meshes with the same content hash, almost always one
+		std::unordered_map<uint64_t, std::vector<std::shared_ptr<const Mesh>>> m_hash_to_mesh{};
+		size_t m_mesh_count{};
+
+	};
+}
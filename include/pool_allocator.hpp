@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Fixed size blocks carved out of chunks, with the free blocks kept in an intrusive list.
+	/// Allocating and freeing pop and push that list, so both take constant time, and objects of
+	/// one type end up next to each other instead of scattered across the heap. Chunks are kept
+	/// until the pool is destroyed. Safe to use from several threads.
+	/// </summary>
+	class BlockPool
+	{
+	public:
+		struct Stats {
+			size_t block_size;
+			size_t live;       // Blocks handed out
+			size_t peak;       // Most blocks handed out at once
+			size_t capacity;   // Blocks in all chunks
+			size_t chunks;
+			uint64_t allocations;
+		};
+
+		/// <param name="block_size">Bytes per block, 0 to take the size of the first allocation</param>
+		/// <param name="blocks_per_chunk">Blocks added whenever the pool runs out</param>
+		explicit BlockPool(std::string name, size_t block_size = 0, size_t blocks_per_chunk = 64);
+		~BlockPool();
+
+		BlockPool(const BlockPool&) = delete;
+		BlockPool& operator=(const BlockPool&) = delete;
+
+		void* allocate(size_t bytes, size_t alignment);
+		void deallocate(void* block);
+
+		Stats getStats() const;
+
+		const std::string& getName() const
+		{
+			return m_name;
+		}
+
+	private:
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		void addChunk();
+
+		mutable std::mutex m_mutex;
+		std::string m_name;
+		size_t m_block_size;
+		size_t m_alignment{ alignof(FreeBlock) };
+		size_t m_blocks_per_chunk;
+		std::vector<void*> m_chunks;
+		FreeBlock* m_free{};
+		size_t m_live{};
+		size_t m_peak{};
+		uint64_t m_allocations{};
+
+	}; // end class
+
+	/// <summary>
+	/// Standard allocator handing out single objects from a BlockPool. Rebinding keeps the pool,
+	/// so std::allocate_shared puts the object and its control block into one block.
+	/// </summary>
+	template<typename T>
+	class PoolAllocator
+	{
+	public:
+		using value_type = T;
+
+		explicit PoolAllocator(BlockPool& pool)
+			: m_pool(&pool)
+		{
+		}
+
+		template<typename U>
+		PoolAllocator(const PoolAllocator<U>& other)
+			: m_pool(other.getPool())
+		{
+		}
+
+		T* allocate(size_t count)
+		{
+			assert(count == 1 && "Pools hand out single objects");
+			return static_cast<T*>(m_pool->allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		void deallocate(T* data, size_t)
+		{
+			m_pool->deallocate(data);
+		}
+
+		BlockPool* getPool() const
+		{
+			return m_pool;
+		}
+
+		template<typename U>
+		bool operator==(const PoolAllocator<U>& other) const
+		{
+			return m_pool == other.getPool();
+		}
+
+		template<typename U>
+		bool operator!=(const PoolAllocator<U>& other) const
+		{
+			return m_pool != other.getPool();
+		}
+
+	private:
+		BlockPool* m_pool;
+
+	}; // end class
+
+	/// <summary>
+	/// Readable name of a type for the pool statistics
+	/// </summary>
+	std::string GetPoolName(const std::type_info& type);
+
+	void VisitPools(void (*visitor)(void* context, const BlockPool& pool), void* context);
+
+	/// <summary>
+	/// Call visitor(const BlockPool&) for every pool alive, e.g. to show their statistics
+	/// </summary>
+	template<typename Visitor>
+	void ForEachPool(Visitor&& visitor)
+	{
+		VisitPools([](void* context, const BlockPool& pool) {
+			(*static_cast<std::remove_reference_t<Visitor>*>(context))(pool);
+		}, const_cast<void*>(static_cast<const void*>(std::addressof(visitor))));
+	}
+
+	/// <summary>
+	/// The pool shared by every MakePooled<T>. It is never destroyed, objects held by static
+	/// singletons can be released during shutdown after function statics are gone.
+	/// </summary>
+	template<typename T>
+	BlockPool& GetPool()
+	{
+		static BlockPool* pool = new BlockPool(GetPoolName(typeid(T)));
+		return *pool;
+	}
+
+	/// <summary>
+	/// std::make_shared with the object and its control block in T's pool
+	/// </summary>
+	template<typename T, typename... Args>
+	std::shared_ptr<T> MakePooled(Args&&... args)
+	{
+		return std::allocate_shared<T>(PoolAllocator<T>(GetPool<T>()), std::forward<Args>(args)...);
+	}
+}; // end namespace
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include "game_object.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Template for spawning many copies of one object. The source object is set up once with its
+	/// textures, shader, geometry and GPU buffers, every instance then shares its mesh, material
+	/// and vertex arrays along with copies of its default transform and motion. Instantiating
+	/// only allocates the object, nothing touches OpenGL or the disk.
+	/// </summary>
+	class Prefab
+	{
+	public:
+		/// <param name="source">Fully initialised object, kept alive by the prefab and never added to a scene</param>
+		explicit Prefab(std::shared_ptr<const GameObject> source);
+
+		/// <summary>
+		/// New object sharing the source's resources, not yet added to the engine
+		/// </summary>
+		std::shared_ptr<GameObject> instantiate() const;
+
+		const std::shared_ptr<const GameObject>& getSource() const
+		{
+			return m_source;
+		}
+
+	private:
+		std::shared_ptr<const GameObject> m_source;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scopes are compiled in when XPLOR_PROFILE is defined (the XPLOR_PROFILER CMake option) and
+// cost one relaxed load each while no capture is running
+#ifdef XPLOR_PROFILE
+#define XPLOR_PROFILE_CONCAT_INNER(a, b) a##b
+#define XPLOR_PROFILE_CONCAT(a, b) XPLOR_PROFILE_CONCAT_INNER(a, b)
+#define XPLOR_PROFILE_SCOPE(name) Xplor::ProfileScope XPLOR_PROFILE_CONCAT(xplor_profile_scope_, __LINE__)(name)
+#define XPLOR_PROFILE_THREAD(name) Xplor::Profiler::setThreadName(name)
+#else
+#define XPLOR_PROFILE_SCOPE(name) ((void)0)
+#define XPLOR_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace Xplor
+{
+	/// <summary>
+	/// Records timed scopes into per-thread buffers while a capture runs and writes the captured
+	/// frames as a Chrome trace (chrome://tracing or ui.perfetto.dev). Each thread only appends
+	/// to its own ring, so recording takes no lock; the main thread reads the rings at the end
+	/// of the capture. Scope names must outlive the capture, string literals are the usual case.
+	/// </summary>
+	class Profiler
+	{
+	public:
+		static constexpr uint32_t EVENTS_PER_THREAD = 1 << 16; // Power of two, later events are dropped
+		static constexpr uint32_t DEFAULT_CAPTURE_FRAMES = 120;
+
+		static bool isCapturing()
+		{
+			return m_capturing.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// High resolution timestamp in nanoseconds
+		/// </summary>
+		static uint64_t now();
+
+		static void record(const char* name, uint64_t start, uint64_t end);
+
+		/// <summary>
+		/// GPU work on its own track, times already converted to the profiler clock.
+		/// Only called from the thread owning the OpenGL context.
+		/// </summary>
+		static void recordGpu(const char* name, uint64_t start, uint64_t end);
+
+		/// <summary>
+		/// Label the calling thread in the trace
+		/// </summary>
+		static void setThreadName(const std::string& name);
+
+		/// <summary>
+		/// Capture the next frames, starting at the next frame boundary
+		/// </summary>
+		/// <param name="path">Trace file, empty for xplor_trace_N.json in the working directory</param>
+		/// <returns>False if a capture is already running</returns>
+		static bool beginCapture(uint32_t frames = DEFAULT_CAPTURE_FRAMES, const std::string& path = {});
+
+		/// <summary>
+		/// Frame boundary, called by the main loop once per frame. Starts a requested capture and
+		/// writes the trace once the last captured frame ended.
+		/// </summary>
+		static void endFrame();
+
+		/// <summary>
+		/// Frames still to be captured, 0 when idle
+		/// </summary>
+		static uint32_t getCaptureFramesLeft();
+
+	private:
+		inline static std::atomic<bool> m_capturing{};
+
+	}; // end class
+
+	/// <summary>
+	/// Times the enclosing scope, use XPLOR_PROFILE_SCOPE so it compiles out with the profiler
+	/// </summary>
+	class ProfileScope
+	{
+	public:
+		explicit ProfileScope(const char* name)
+			: m_name(name), m_start(Profiler::isCapturing() ? Profiler::now() : 0)
+		{
+		}
+
+		~ProfileScope()
+		{
+			if (m_start)
+				Profiler::record(m_name, m_start, Profiler::now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+
+	private:
+		const char* m_name;
+		uint64_t m_start;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "frame_packet.hpp"
+#include "renderer.hpp"
+
+struct GLFWwindow;
+
+namespace Xplor
+{
+	/// <summary>
+	/// Dedicated thread that owns the OpenGL context and executes frame packets. Packets are
+	/// double buffered: the simulation thread fills one while the other is being drawn, so the
+	/// simulation can run at most one frame ahead of the GPU submission.
+	/// </summary>
+	class RenderThread
+	{
+	public:
+		~RenderThread();
+
+		/// <summary>
+		/// Take the OpenGL context from the calling thread and start executing packets
+		/// </summary>
+		void start(GLFWwindow* window, Renderer* renderer);
+
+		/// <summary>
+		/// Draw the last submitted packet, stop the thread and make the context current on the
+		/// calling thread again
+		/// </summary>
+		void stop();
+
+		bool isRunning() const
+		{
+			return m_running;
+		}
+
+		/// <summary>
+		/// Get the packet to fill for the next frame. Blocks while the render thread is still
+		/// drawing it.
+		/// </summary>
+		FramePacket& acquirePacket();
+
+		/// <summary>
+		/// Hand the packet returned by acquirePacket to the render thread
+		/// </summary>
+		void submit();
+
+		/// <summary>
+		/// Block until every submitted packet has been drawn
+		/// </summary>
+		void waitIdle();
+
+		/// <summary>
+		/// Run work that needs the OpenGL context (resource creation, deletion) and wait for it.
+		/// Runs inline when the thread is not started or when called from the render thread.
+		/// </summary>
+		void runOnRenderThread(const std::function<void()>& command);
+
+	private:
+		void threadMain();
+
+		std::thread m_thread;
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+
+		std::array<FramePacket, 2> m_packets;
+		std::array<bool, 2> m_in_flight{}; // Submitted and not yet drawn
+		uint32_t m_write_index{};
+		int m_pending{ -1 }; // Packet waiting to be picked up by the render thread
+
+		std::deque<std::function<void()>> m_commands;
+
+		GLFWwindow* m_window{};
+		Renderer* m_renderer{};
+		bool m_running{};
+		bool m_stop{};
+
+	}; // end class
+}; // end namespace
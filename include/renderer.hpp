@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "frame_packet.hpp"
+#include "uniform_ring.hpp"
+#include "debug_draw.hpp"
+#include "gpu_timer.hpp"
+#include "shader.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Owns the per-frame GPU resources and turns a FramePacket into OpenGL calls.
+	/// Every method must be called on the thread that owns the OpenGL context.
+	/// </summary>
+	class Renderer
+	{
+	public:
+		void init();
+
+		void shutdown();
+
+		/// <summary>
+		/// Draw a complete frame, excluding the buffer swap
+		/// </summary>
+		/// <param name="out_stats">Draw counts of the packet, the render thread does not touch the global counters</param>
+		void execute(const FramePacket& packet, StatCounts& out_stats);
+
+		/// <summary>
+		/// GPU time of the render passes, readable from any thread
+		/// </summary>
+		const GpuTimer& getGpuTimer() const
+		{
+			return m_gpu_timer;
+		}
+
+	private:
+		UniformRing m_uniform_ring;
+		DebugDraw m_debug_draw;
+		GpuTimer m_gpu_timer;
+		// Offsets of each draw's ObjectUniforms inside the uniform ring
+		std::vector<size_t> m_object_offsets;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "simd.hpp"
+#include "xplor_types.hpp"
+
+namespace Xplor
+{
+	struct RayHit {
+		static constexpr uint32_t NO_HIT = std::numeric_limits<uint32_t>::max();
+
+		uint32_t object; // Item index of the closest box, NO_HIT if the ray missed everything
+		float t;         // Distance along the ray direction
+	};
+
+	struct BVHBox {
+		float min[3];
+		float max[3];
+	};
+
+	struct BVHNode {
+		float min[3];
+		uint32_t left_first; // Index of the left child, the right child follows it. First item for leaves.
+		float max[3];
+		uint32_t count;      // Items in a leaf, 0 for inner nodes
+	};
+
+	/// <summary>
+	/// Ray arrays of one intersect call, split per component for packet loads. Kernels built
+	/// for AVX only see these raw pointers, see KinematicsStreams.
+	/// </summary>
+	struct RayStreams {
+		const float* origin_x;
+		const float* origin_y;
+		const float* origin_z;
+		const float* inv_direction_x;
+		const float* inv_direction_y;
+		const float* inv_direction_z;
+		uint32_t* hit_object;
+		float* hit_t;
+		size_t count;
+	};
+
+	/// <summary>
+	/// Bounding volume hierarchy over boxes for ray queries, used for the objects of the scene
+	/// and for the triangles of each mesh. Rays are traced in
+	/// packets of 4 (SSE) or 8 (AVX): every node is slab tested against the whole packet at once
+	/// and a subtree is only skipped when no ray in the packet can hit it closer than its current
+	/// hit. Coherent rays such as a marquee selection or hover picking share most of their
+	/// traversal, so thousands of rays per frame stay cheap.
+	/// </summary>
+	class SceneBVH
+	{
+	public:
+		static constexpr uint32_t MAX_LEAF_SIZE = 4;
+		static constexpr uint32_t MAX_DEPTH = 64;
+
+		/// <summary>
+		/// Build the tree from scratch, item i is the box at bounds[i]
+		/// </summary>
+		void build(const std::vector<BoundingBox>& bounds);
+
+		/// <summary>
+		/// Update the boxes of the current items and refit the nodes without changing the tree.
+		/// Much cheaper than build but the tree degrades when items move far. An item can be taken
+		/// out by giving it an empty box (min at +FLT_MAX, max at -FLT_MAX), rays never hit it.
+		/// </summary>
+		void refit(const std::vector<BoundingBox>& bounds);
+
+		/// <summary>
+		/// Closest hit for each ray. Rays must have direction_inv filled in.
+		/// Distinct ray ranges may be traced from several threads.
+		/// </summary>
+		void intersect(const Ray* rays, size_t count, RayHit* out_hits) const;
+
+		/// <summary>
+		/// Walk one ray through the tree, nearer subtrees first, calling visitor(item, t_entry) for
+		/// every item box the ray enters before max_t. The visitor returns the new max_t, so a
+		/// precise test on the item (e.g. against triangles) prunes everything behind its hit.
+		/// </summary>
+		template<typename Visitor>
+		void traverse(const Ray& ray, float max_t, Visitor&& visitor) const
+		{
+			if (m_nodes.empty())
+				return;
+
+			uint32_t stack[MAX_DEPTH * 2];
+			uint32_t stack_size = 0;
+			stack[stack_size++] = 0;
+
+			while (stack_size > 0)
+			{
+				const BVHNode& node = m_nodes[stack[--stack_size]];
+				float t_near;
+				if (!slabTest(node.min, node.max, ray, max_t, t_near))
+					continue;
+
+				if (node.count > 0)
+				{
+					for (uint32_t i = node.left_first; i < node.left_first + node.count; i++)
+					{
+						const BVHBox& box = m_item_boxes[i];
+						if (slabTest(box.min, box.max, ray, max_t, t_near))
+							max_t = visitor(m_items[i], t_near);
+					}
+					continue;
+				}
+
+				// Push the farther child first, judged by the ray direction along the node's widest axis
+				const BVHNode& left = m_nodes[node.left_first];
+				const BVHNode& right = m_nodes[node.left_first + 1];
+				int axis = 0;
+				float widest = node.max[0] - node.min[0];
+				for (int i = 1; i < 3; i++)
+				{
+					if (node.max[i] - node.min[i] > widest)
+					{
+						widest = node.max[i] - node.min[i];
+						axis = i;
+					}
+				}
+				const bool left_first = (left.min[axis] + left.max[axis] <= right.min[axis] + right.max[axis]) == (ray.direction[axis] >= 0.0f);
+				stack[stack_size++] = left_first ? node.left_first + 1 : node.left_first;
+				stack[stack_size++] = left_first ? node.left_first : node.left_first + 1;
+			}
+		}
+
+		size_t getItemCount() const
+		{
+			return m_items.size();
+		}
+
+		size_t getNodeCount() const
+		{
+			return m_nodes.size();
+		}
+
+	private:
+		static bool slabTest(const float* box_min, const float* box_max, const Ray& ray, float max_t, float& out_near)
+		{
+			// Empty boxes are inverted on every axis, the slab intervals alone would accept them
+			if (box_min[0] > box_max[0])
+				return false;
+
+			float t_near = 0.0f;
+			float t_far = max_t;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float t1 = (box_min[axis] - ray.origin[axis]) * ray.direction_inv[axis];
+				float t2 = (box_max[axis] - ray.origin[axis]) * ray.direction_inv[axis];
+				t_near = std::max(t_near, std::min(t1, t2));
+				t_far = std::min(t_far, std::max(t1, t2));
+			}
+			// Widen the exit slightly so rounding never rejects a ray grazing a flat box, such as the
+			// box of an axis aligned triangle, which would let picks slip through shared edges
+			out_near = t_near;
+			return t_near <= t_far * 1.0000008f;
+		}
+
+		void subdivide(uint32_t node_index, uint32_t depth);
+		void updateNodeBounds(uint32_t node_index);
+
+		std::vector<BVHNode> m_nodes;
+		std::vector<uint32_t> m_items;        // Item indices in leaf order
+		std::vector<BVHBox> m_item_boxes;     // Boxes in leaf order
+		std::vector<glm::vec3> m_centroids;   // Build scratch, per item index
+
+	}; // end class
+
+	namespace Detail
+	{
+		// Closest hits for the rays, the hit arrays must be initialised to NO_HIT and the maximum distance
+		void IntersectBVHScalar(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays);
+#if XPLOR_SIMD_X86
+		void IntersectBVHSSE(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays);
+		void IntersectBVHAVX(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays);
+#endif
+	}
+}; // end namespace
@@ -7,10 +7,14 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "xplor_types.hpp"
+#include "string_id.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 
 
 namespace Xplor
@@ -32,6 +36,7 @@ namespace Xplor
 
 		void init()
 		{
+			XPLOR_PROFILE_SCOPE("Shader Compile");
 			if (m_fragmentPath.empty() || m_vertexPath.empty())
 			{
 				assert(false && "Shader paths are not defined");
@@ -64,7 +69,7 @@ namespace Xplor
 			catch (std::ifstream::failure exception)
 			{
 				__debugbreak(); // Windows only
-				std::cout << "ERROR: Shader file could not be read" << std::endl;
+				XPLOR_LOG_ERROR(Shader, "Shader file could not be read: %s, %s", m_vertexPath.c_str(), m_fragmentPath.c_str());
 			}
 
 			//-- Compile Input Shaders
@@ -87,19 +92,45 @@ namespace Xplor
 			if (!linkSuccess)
 			{
 				glGetProgramInfoLog(m_shaderID, 512, NULL, infoLog);
-				std::cout << "ERROR: SHADER_PROGRAM Link FAILED\n" << infoLog << std::endl;
+				XPLOR_LOG_ERROR(Shader, "Shader program link failed\n%s", infoLog);
 			}
 
 
 			glDeleteShader(vertex);
 			glDeleteProgram(fragment);
+
+			// Locations belong to the previous program if this shader was re-initialized
+			m_uniformLocations.clear();
+			m_bound_material = 0;
+
+			bindUniformBlocks();
 		}
 
 		/// <summary>
 		/// 
 		/// </summary>
 		/// <returns></returns>
-		uint32_t getID();
+		uint32_t getID() const;
+
+		/// <summary>
+		/// Look up a uniform location, caching the result so repeated lookups avoid the driver
+		/// </summary>
+		/// <param name="name">Interned uniform name, the first lookup passes its text to the driver</param>
+		/// <returns>The uniform location or -1 if the program has no active uniform with that name</returns>
+		GLint getUniformLocation(StringId name) const;
+
+		/// <summary>
+		/// ID of the material whose parameters are currently loaded into the program
+		/// </summary>
+		uint32_t getBoundMaterial() const
+		{
+			return m_bound_material;
+		}
+
+		void setBoundMaterial(uint32_t material_id)
+		{
+			m_bound_material = material_id;
+		}
 
 		/// <summary>
 		/// Use the current shader program
@@ -116,33 +147,22 @@ namespace Xplor
 		/// </summary>
 		/// <param name="name"></param>
 		/// <param name="value"></param>
-		void setUniform(const std::string& name, int value);
+		void setUniform(StringId name, int value) const;
 
 		/// <summary>
 		/// Defines a 4x4 glm matrix for the shader
 		/// </summary>
 		/// <param name="name"></param>
 		/// <param name="value"></param>
-		void setUniform(const std::string& name, glm::mat4 value) const;
-
-		
-		void PassUniformInts()
-		{
-			//useProgram();
-			for (auto pair : m_uniformInts)
-			{
-				glUniform1i(glGetUniformLocation(m_shaderID, std::get<0>(pair).c_str()), std::get<1>(pair));
+		void setUniform(StringId name, glm::mat4 value) const;
 
-			}
-			//endProgram();
-		}
 
 		/// <summary>
 		/// Defines a boolean uniform for the shader
 		/// </summary>
 		/// <param name="name"></param>
 		/// <param name="value"></param>
-		void setUniform(const std::string& name, bool value) const;
+		void setUniform(StringId name, bool value) const;
 
 
 		/// <summary>
@@ -150,7 +170,7 @@ namespace Xplor
 		/// </summary>
 		/// <param name="name"></param>
 		/// <param name="value"></param>
-		void setUniform(const std::string& name, float value) const;
+		void setUniform(StringId name, float value) const;
 
 		void Delete();
 
@@ -158,8 +178,7 @@ namespace Xplor
 		{
 			return {
 				{"vertexPath", m_vertexPath},
-				{"fragmentPath", m_fragmentPath},
-				{"uniform ints", m_uniformInts}
+				{"fragmentPath", m_fragmentPath}
 			};
 		}
 
@@ -167,8 +186,7 @@ namespace Xplor
 		{
 			m_vertexPath = j.at("vertexPath").get<std::string>();
 			m_fragmentPath = j.at("fragmentPath").get<std::string>();
-			m_uniformInts = j.at("uniform ints");
-			PassUniformInts(); // push all the ints to the shader
+			m_uniformLocations.clear();
 		}
 
 
@@ -176,13 +194,20 @@ namespace Xplor
 		// Program ID
 		uint32_t m_shaderID{};
 
+		/// <summary>
+		/// Point the engine's shared uniform blocks at their fixed binding points.
+		/// GLSL 330 has no layout(binding) qualifier so this has to happen after linking.
+		/// </summary>
+		void bindUniformBlocks() const;
+
 		GLuint compileShader(int shaderType, const char * shaderSource) const;
 
 	private:
 		std::string m_vertexPath{};
 		std::string m_fragmentPath{};
 
-		std::vector<std::tuple<std::string, int>> m_uniformInts{};
+		mutable std::unordered_map<StringId, GLint> m_uniformLocations{};
+		uint32_t m_bound_material{};
 
 
 
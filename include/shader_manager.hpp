@@ -5,6 +5,7 @@
 #include <memory>
 #include "manager.hpp"
 #include "shader.hpp"
+#include "string_id.hpp"
 
 namespace Xplor
 {
@@ -16,15 +17,15 @@ namespace Xplor
 		ShaderManager();
 		//static std::shared_ptr<ShaderManager> getInstance();
 
-		std::shared_ptr<Shader> createShader(const std::string& name, const std::string& vertex_path, const std::string& fragment_path);
-		bool findShader(const std::string& name, std::shared_ptr<Shader>& out_shader) const;
+		std::shared_ptr<Shader> createShader(StringId name, const std::string& vertex_path, const std::string& fragment_path);
+		bool findShader(StringId name, std::shared_ptr<Shader>& out_shader) const;
 
 	protected:
 
 	private:
 		//static std::shared_ptr<ShaderManager> m_instance;
-		std::unordered_map<std::string, std::shared_ptr<Shader>> m_name_to_shader{};
-		std::unordered_map<int, std::string> m_id_to_name{};
+		std::unordered_map<StringId, std::shared_ptr<Shader>> m_name_to_shader{};
+		std::unordered_map<int, StringId> m_id_to_name{};
 
 		
 
@@ -0,0 +1,35 @@
+#pragma once
+
+// SSE kernels are built on every x86 target. AVX kernels live in *_avx.cpp files compiled for
+// AVX and are only called once GetSupportedSimdLevel reports AVX.
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define XPLOR_SIMD_X86 1
+#else
+#define XPLOR_SIMD_X86 0
+#endif
+
+namespace Xplor
+{
+	enum class SimdLevel {
+		Scalar,
+		SSE,
+		AVX
+	};
+
+	/// <summary>
+	/// Widest instruction set supported by the CPU and the OS
+	/// </summary>
+	SimdLevel GetSupportedSimdLevel();
+
+	/// <summary>
+	/// Instruction set used by the batched kernels, defaults to the supported level
+	/// </summary>
+	SimdLevel GetSimdLevel();
+
+	/// <summary>
+	/// Force a narrower instruction set, e.g. to compare kernels. Clamped to the supported level.
+	/// </summary>
+	void SetSimdLevel(SimdLevel level);
+
+	const char* GetSimdLevelName(SimdLevel level);
+}; // end namespace
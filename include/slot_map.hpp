@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Generational reference into a SlotMap. The index names a slot that stays put for the
+	/// lifetime of the item, the generation tells a live item from an earlier one that used
+	/// the same slot, so a stale handle is detected instead of reaching the new item.
+	/// </summary>
+	struct Handle {
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+		uint32_t index{ INVALID_INDEX };
+		uint32_t generation{};
+
+		bool isValid() const
+		{
+			return index != INVALID_INDEX;
+		}
+
+		bool operator==(const Handle& other) const
+		{
+			return index == other.index && generation == other.generation;
+		}
+
+		bool operator!=(const Handle& other) const
+		{
+			return !(*this == other);
+		}
+	};
+
+	/// <summary>
+	/// Items in a dense array for iteration, addressed through stable slots. Insertion, lookup
+	/// and removal are O(1): removing moves the last item into the hole and repoints its slot.
+	/// Systems that key data by object can use the slot index directly, it only changes meaning
+	/// once the item is removed.
+	/// </summary>
+	template<typename T>
+	class SlotMap
+	{
+	public:
+		Handle insert(T value)
+		{
+			uint32_t slot;
+			if (m_free_head != NONE)
+			{
+				slot = m_free_head;
+				m_free_head = m_slots[slot].dense;
+			}
+			else
+			{
+				slot = static_cast<uint32_t>(m_slots.size());
+				m_slots.push_back({});
+			}
+
+			m_slots[slot].dense = static_cast<uint32_t>(m_values.size());
+			m_values.push_back(std::move(value));
+			m_dense_to_slot.push_back(slot);
+			return { slot, m_slots[slot].generation };
+		}
+
+		/// <summary>
+		/// Remove the item, handles to it become stale
+		/// </summary>
+		/// <returns>False if the handle was already stale</returns>
+		bool remove(Handle handle)
+		{
+			if (!contains(handle))
+				return false;
+
+			// Fill the hole with the last item so the dense array stays packed
+			const uint32_t dense = m_slots[handle.index].dense;
+			const uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+			if (dense != last)
+			{
+				m_values[dense] = std::move(m_values[last]);
+				m_dense_to_slot[dense] = m_dense_to_slot[last];
+				m_slots[m_dense_to_slot[dense]].dense = dense;
+			}
+			m_values.pop_back();
+			m_dense_to_slot.pop_back();
+
+			Slot& slot = m_slots[handle.index];
+			slot.generation++;
+			slot.dense = m_free_head;
+			m_free_head = handle.index;
+			return true;
+		}
+
+		bool contains(Handle handle) const
+		{
+			return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation &&
+				m_slots[handle.index].dense < m_values.size() && m_dense_to_slot[m_slots[handle.index].dense] == handle.index;
+		}
+
+		/// <summary>
+		/// Item for a handle, null if the handle is stale
+		/// </summary>
+		T* get(Handle handle)
+		{
+			return contains(handle) ? &m_values[m_slots[handle.index].dense] : nullptr;
+		}
+
+		const T* get(Handle handle) const
+		{
+			return contains(handle) ? &m_values[m_slots[handle.index].dense] : nullptr;
+		}
+
+		/// <summary>
+		/// Item in a live slot, for systems that store slot indices of items they are told about on removal
+		/// </summary>
+		T& atSlot(uint32_t slot)
+		{
+			assert(slot < m_slots.size() && m_slots[slot].dense < m_values.size() && m_dense_to_slot[m_slots[slot].dense] == slot && "Slot is not in use");
+			return m_values[m_slots[slot].dense];
+		}
+
+		const T& atSlot(uint32_t slot) const
+		{
+			assert(slot < m_slots.size() && m_slots[slot].dense < m_values.size() && m_dense_to_slot[m_slots[slot].dense] == slot && "Slot is not in use");
+			return m_values[m_slots[slot].dense];
+		}
+
+		/// <summary>
+		/// Handle of the item at a position in the dense array
+		/// </summary>
+		Handle getHandle(size_t dense) const
+		{
+			const uint32_t slot = m_dense_to_slot[dense];
+			return { slot, m_slots[slot].generation };
+		}
+
+		uint32_t getSlot(size_t dense) const
+		{
+			return m_dense_to_slot[dense];
+		}
+
+		void clear()
+		{
+			// Bump every generation so handles from before the clear stay stale
+			m_values.clear();
+			m_dense_to_slot.clear();
+			m_free_head = NONE;
+			for (uint32_t slot = static_cast<uint32_t>(m_slots.size()); slot-- > 0;)
+			{
+				m_slots[slot].generation++;
+				m_slots[slot].dense = m_free_head;
+				m_free_head = slot;
+			}
+		}
+
+		size_t size() const
+		{
+			return m_values.size();
+		}
+
+		bool empty() const
+		{
+			return m_values.empty();
+		}
+
+		/// <summary>
+		/// Upper bound of the slot indices handed out so far
+		/// </summary>
+		size_t getSlotCount() const
+		{
+			return m_slots.size();
+		}
+
+		T& operator[](size_t dense)
+		{
+			return m_values[dense];
+		}
+
+		const T& operator[](size_t dense) const
+		{
+			return m_values[dense];
+		}
+
+		typename std::vector<T>::iterator begin() { return m_values.begin(); }
+		typename std::vector<T>::iterator end() { return m_values.end(); }
+		typename std::vector<T>::const_iterator begin() const { return m_values.begin(); }
+		typename std::vector<T>::const_iterator end() const { return m_values.end(); }
+
+	private:
+		static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+		struct Slot {
+			uint32_t dense{};      // Position in m_values, next free slot while unused
+			uint32_t generation{};
+		};
+
+		std::vector<Slot> m_slots;
+		std::vector<T> m_values;
+		std::vector<uint32_t> m_dense_to_slot;
+		uint32_t m_free_head{ NONE };
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Xplor
+{
+	enum class Stat : uint32_t
+	{
+		DrawCalls = 0,
+		Triangles,
+		StateChanges,     // Program or material switches between draws
+		BufferBytes,      // Bytes copied into GPU buffers
+		TexturesBound,
+		ObjectsUpdated,   // Awake objects integrated, summed over the frame's ticks
+		ObjectsCulled,
+		ObjectsVisible,
+		HeapAllocations,  // 0 unless the allocation counter is compiled in
+		Count
+	};
+
+	/// <summary>
+	/// Counts gathered for one unit of work and handed over as a whole, e.g. by the renderer
+	/// while drawing a frame packet. Plain values, only one thread writes them at a time.
+	/// </summary>
+	struct StatCounts {
+		std::array<uint64_t, static_cast<uint32_t>(Stat::Count)> values{};
+
+		void add(Stat stat, uint64_t amount = 1)
+		{
+			values[static_cast<uint32_t>(stat)] += amount;
+		}
+	};
+
+	/// <summary>
+	/// Engine counters, incremented from any simulation thread and summed once per frame. Every
+	/// thread adds to its own counters, so an increment is a plain load and store with no
+	/// contention, and endFrame turns the running totals into per-frame values. The render thread
+	/// draws a packet while the next frame is built, so it counts into the packet instead and the
+	/// packet's counts are merged as a whole once it retired. Also keeps the frame times for
+	/// percentiles and spike detection. Everything but add() is for the main thread only.
+	/// </summary>
+	class Stats
+	{
+	public:
+		static constexpr uint32_t STAT_COUNT = static_cast<uint32_t>(Stat::Count);
+		static constexpr uint32_t HISTORY_SIZE = 600;
+		static constexpr uint32_t MAX_SPIKES = 16;
+		static constexpr float SPIKE_FACTOR = 2.0f; // Frames this many times the median are spikes
+
+		using FrameTimes = std::array<float, HISTORY_SIZE>;
+
+		struct Spike {
+			uint64_t frame;
+			float ms;
+		};
+
+		static void add(Stat stat, uint64_t amount = 1)
+		{
+			std::atomic<uint64_t>& value = getThreadCounters().values[static_cast<uint32_t>(stat)];
+			value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Close the frame: merge the thread counters and record its duration
+		/// </summary>
+		static void endFrame(float frame_ms);
+
+		/// <summary>
+		/// Counts of a frame packet that finished drawing, reported by the next endFrame
+		/// </summary>
+		static void addPacket(const StatCounts& counts);
+
+		/// <summary>
+		/// Value of the last finished frame
+		/// </summary>
+		static uint64_t get(Stat stat);
+
+		static const char* GetStatName(Stat stat);
+
+		/// <summary>
+		/// Frame times, oldest first starting at out_offset
+		/// </summary>
+		static const FrameTimes& getFrameTimes(uint32_t& out_offset);
+
+		static uint32_t getFrameTimeCount();
+
+		/// <summary>
+		/// Frame time below which the given fraction of the recorded frames fall, e.g. 0.99
+		/// </summary>
+		static float getPercentile(float fraction);
+
+		static float getMaxFrameTime();
+
+		/// <summary>
+		/// Recent spikes, oldest first
+		/// </summary>
+		static const Spike* getSpikes(uint32_t& out_count);
+
+		static uint64_t getFrameIndex();
+
+	private:
+		struct Counters {
+			std::array<std::atomic<uint64_t>, STAT_COUNT> values{}; // Running totals, written by one thread
+		};
+
+		struct State;
+		static State& getState();
+
+		static Counters& getThreadCounters()
+		{
+			if (!t_counters)
+				t_counters = registerThread();
+			return *t_counters;
+		}
+
+		static Counters* registerThread();
+
+		inline static thread_local Counters* t_counters = nullptr;
+
+	}; // end class
+}; // end namespace
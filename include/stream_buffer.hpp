@@ -0,0 +1,115 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Buffer for data rewritten every frame. The buffer is split into one region per frame in
+	/// flight and each region is guarded by a fence, so the CPU only writes memory the GPU has
+	/// finished reading and never stalls on glBufferData.
+	/// With GL 4.4 / ARB_buffer_storage the buffer is persistently and coherently mapped and
+	/// writes go straight to GPU visible memory. On GL 3.3 writes are staged and copied in with
+	/// an unsynchronized glMapBufferRange, the storage is orphaned when it has to grow.
+	/// Usage per frame: beginFrame, allocate/write, flush, issue draws, endFrame.
+	/// </summary>
+	class StreamBuffer
+	{
+	public:
+		static constexpr uint32_t FRAME_COUNT = 3;
+
+		StreamBuffer() = default;
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		/// <summary>
+		/// Create the buffer. Requires a current OpenGL context.
+		/// </summary>
+		/// <param name="target">Binding target used while creating and mapping, e.g. GL_ARRAY_BUFFER</param>
+		/// <param name="frame_size">Bytes available to each frame region, grows on demand</param>
+		/// <param name="region_alignment">Alignment of each region's start inside the buffer</param>
+		void init(GLenum target, size_t frame_size, size_t region_alignment = 1);
+
+		void destroy();
+
+		/// <summary>
+		/// Move to the next region, waiting for the GPU if it is still reading it
+		/// </summary>
+		void beginFrame();
+
+		/// <summary>
+		/// Reserve space in the current region
+		/// </summary>
+		/// <param name="alignment">Any positive value, e.g. a vertex stride or the UBO offset alignment</param>
+		/// <returns>Offset of the allocation relative to the start of the current region</returns>
+		size_t allocate(size_t size, size_t alignment = 1);
+
+		/// <summary>
+		/// CPU address of an allocation made this frame. Only valid until the next allocate call.
+		/// </summary>
+		void* getPointer(size_t offset);
+
+		/// <summary>
+		/// Copy data into the current region
+		/// </summary>
+		/// <returns>Offset of the data relative to the start of the current region</returns>
+		size_t write(const void* data, size_t size, size_t alignment = 1);
+
+		/// <summary>
+		/// Make everything written this frame visible to the GPU. Must be called before any draw
+		/// reads the region.
+		/// </summary>
+		void flush();
+
+		/// <summary>
+		/// Fence the current region so it is not overwritten while the GPU reads it
+		/// </summary>
+		void endFrame();
+
+		GLuint getBuffer() const
+		{
+			return m_buffer;
+		}
+
+		/// <summary>
+		/// Byte offset of the current region inside the buffer
+		/// </summary>
+		size_t getRegionOffset() const
+		{
+			return m_frame * m_frame_size;
+		}
+
+		size_t getUsedSize() const
+		{
+			return m_cursor;
+		}
+
+		bool isPersistent() const
+		{
+			return m_persistent;
+		}
+
+	private:
+		void create();
+		void grow(size_t frame_size);
+		void waitForFence(uint32_t frame);
+
+		GLenum m_target{ GL_ARRAY_BUFFER };
+		GLuint m_buffer{};
+		bool m_persistent{};
+		uint8_t* m_mapped{}; // Persistent mapping of the whole buffer
+		std::vector<uint8_t> m_staging{}; // Current region contents when the buffer can not stay mapped
+
+		size_t m_frame_size{};
+		size_t m_region_alignment{ 1 };
+		size_t m_cursor{};
+		uint32_t m_frame{};
+		std::array<GLsync, FRAME_COUNT> m_fences{};
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <nlohmann/json.hpp>
+
+namespace Xplor
+{
+	/// <summary>
+	/// 32-bit FNV-1a hash, constexpr so literal names hash at compile time
+	/// </summary>
+	constexpr uint32_t HashString(std::string_view text)
+	{
+		uint32_t hash = 2166136261u;
+		for (char c : text)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	/// <summary>
+	/// Name stored once in a global table and passed around as its 32-bit hash, so comparing
+	/// and looking up names compares integers. Constructing from a string interns it, the text
+	/// can be read back with getString(). The id is the hash itself, which keeps it stable
+	/// across runs and lets "name"_sid produce the same id at compile time without touching
+	/// the table. The empty string has id 0. A name whose hash is already taken by another
+	/// name is logged as an error and gets the empty id, so it never resolves to the other one.
+	/// </summary>
+	class StringId
+	{
+	public:
+		constexpr StringId() = default;
+
+		StringId(std::string_view text);
+
+		StringId(const char* text)
+			: StringId(std::string_view(text))
+		{
+		}
+
+		StringId(const std::string& text)
+			: StringId(std::string_view(text))
+		{
+		}
+
+		/// <summary>
+		/// Id of an already hashed name, the table is not touched
+		/// </summary>
+		static constexpr StringId FromHash(uint32_t hash)
+		{
+			StringId id;
+			id.m_hash = hash;
+			return id;
+		}
+
+		constexpr uint32_t getHash() const
+		{
+			return m_hash;
+		}
+
+		constexpr bool empty() const
+		{
+			return m_hash == 0;
+		}
+
+		/// <summary>
+		/// Interned text, empty if the id only came from a literal and the string was never interned
+		/// </summary>
+		const std::string& getString() const;
+
+		const char* c_str() const
+		{
+			return getString().c_str();
+		}
+
+		constexpr bool operator==(StringId other) const
+		{
+			return m_hash == other.m_hash;
+		}
+
+		constexpr bool operator!=(StringId other) const
+		{
+			return m_hash != other.m_hash;
+		}
+
+		constexpr bool operator<(StringId other) const
+		{
+			return m_hash < other.m_hash;
+		}
+
+	private:
+		uint32_t m_hash{};
+
+	}; // end class
+
+	inline namespace literals
+	{
+		/// <summary>
+		/// Compile time id for lookups of names interned elsewhere, e.g. findShader("bounding"_sid)
+		/// </summary>
+		constexpr StringId operator""_sid(const char* text, size_t length)
+		{
+			return StringId::FromHash(length == 0 ? 0 : HashString(std::string_view(text, length)));
+		}
+	}
+
+	inline void to_json(nlohmann::json& j, const StringId& id)
+	{
+		j = id.getString();
+	}
+
+	inline void from_json(const nlohmann::json& j, StringId& id)
+	{
+		id = StringId(j.get<std::string>());
+	}
+}; // end namespace
+
+template<>
+struct std::hash<Xplor::StringId>
+{
+	size_t operator()(Xplor::StringId id) const noexcept
+	{
+		return id.getHash();
+	}
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "job_system.hpp"
+
+namespace Xplor
+{
+	struct TaskTiming {
+		float start_ms; // Relative to the start of the graph execution
+		float end_ms;
+		bool on_critical_path;
+	};
+
+	/// <summary>
+	/// Frame work declared as a dependency graph of stages. Stages whose dependencies are done
+	/// run in parallel on the job system, stages flagged main thread only (input, windowing,
+	/// ImGui) run on the thread calling execute. While none of those is ready the calling thread
+	/// helps with the jobs the worker stages queued, never with a whole stage. After each
+	/// execution the graph reports the critical path, the longest chain of dependent stages,
+	/// which bounds the frame time no matter how many threads are available.
+	/// </summary>
+	class TaskGraph
+	{
+	public:
+		using TaskId = uint32_t;
+
+		/// <summary>
+		/// Declare a stage. Dependencies must be declared before the stages depending on them.
+		/// </summary>
+		/// <param name="name">Shown in the editor</param>
+		/// <param name="function">Work of the stage, may use the job system itself</param>
+		/// <param name="dependencies">Stages that have to finish before this one starts</param>
+		/// <param name="main_thread">Run on the thread calling execute</param>
+		TaskId addTask(const std::string& name, std::function<void()> function, const std::vector<TaskId>& dependencies = {}, bool main_thread = false);
+
+		/// <summary>
+		/// Run every stage once, returns when all are finished
+		/// </summary>
+		void execute();
+
+		size_t getTaskCount() const
+		{
+			return m_tasks.size();
+		}
+
+		const std::string& getTaskName(TaskId task) const
+		{
+			return m_tasks[task].name;
+		}
+
+		/// <summary>
+		/// Timing of the task in the last completed execution
+		/// </summary>
+		const TaskTiming& getTaskTiming(TaskId task) const
+		{
+			return m_last_timings[task];
+		}
+
+		/// <summary>
+		/// Sum of the stage durations along the longest dependency chain of the last execution
+		/// </summary>
+		float getCriticalPathMs() const
+		{
+			return m_critical_path_ms;
+		}
+
+		/// <summary>
+		/// Wall clock duration of the last execution
+		/// </summary>
+		float getExecutionMs() const
+		{
+			return m_execution_ms;
+		}
+
+	private:
+		struct Task {
+			std::string name;
+			std::function<void()> function;
+			std::vector<TaskId> successors;
+			uint32_t dependency_count;
+			bool main_thread;
+		};
+
+		void schedule(TaskId task);
+		void runTask(TaskId task);
+		void computeCriticalPath();
+
+		std::vector<Task> m_tasks;
+		std::vector<TaskTiming> m_timings; // Written while executing
+		std::vector<TaskTiming> m_last_timings; // Published once an execution finished, safe to read from a task
+
+		// Per execution state
+		std::unique_ptr<std::atomic<uint32_t>[]> m_pending_dependencies;
+		std::atomic<uint32_t> m_remaining{};
+		std::vector<TaskId> m_main_queue;
+		std::mutex m_main_mutex;
+		std::chrono::steady_clock::time_point m_start;
+
+		// Critical path scratch, kept so executing does not allocate
+		std::vector<float> m_path_ms;
+		std::vector<int> m_previous;
+		float m_critical_path_ms{};
+		float m_execution_ms{};
+
+	}; // end class
+}; // end namespace
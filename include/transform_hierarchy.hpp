@@ -0,0 +1,143 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace Xplor
+{
+	/// <summary>
+	/// Parent/child transforms stored in one flat array sorted so every parent comes before its
+	/// children. Updating is a single linear pass: a node's world matrix is only recomputed when
+	/// its local matrix was set or its parent's world changed in the same pass, so a dirty flag
+	/// on a moving platform reaches the props attached to it while everything else is skipped.
+	/// Local matrices are cached, a child of a moved parent costs one matrix multiply.
+	/// Ids are stable. Slots move when a node is attached to a parent behind it, which rebuilds
+	/// the order, and when destroyed nodes are compacted away at the start of the next update.
+	/// </summary>
+	class TransformHierarchy
+	{
+	public:
+		using TransformId = uint32_t;
+		static constexpr TransformId INVALID_TRANSFORM = std::numeric_limits<uint32_t>::max();
+
+		/// <summary>
+		/// Add a transform, its world matrix is valid right away
+		/// </summary>
+		/// <param name="user_data">Reported back for changed nodes, e.g. an object index</param>
+		TransformId create(uint32_t user_data, const glm::mat4& local = glm::mat4(1.0f), TransformId parent = INVALID_TRANSFORM);
+
+		/// <summary>
+		/// Remove a transform, its children become roots keeping their local transforms. The slot
+		/// is freed by the next update, one pass for every transform destroyed since.
+		/// </summary>
+		void destroy(TransformId id);
+
+		/// <summary>
+		/// Attach to a parent or detach with INVALID_TRANSFORM. The local transform is kept, so it
+		/// is now relative to the new parent.
+		/// </summary>
+		void setParent(TransformId id, TransformId parent);
+
+		TransformId getParent(TransformId id) const;
+
+		/// <summary>
+		/// Set the transform relative to the parent. Distinct ids may be set from several threads.
+		/// </summary>
+		/// <param name="snap">Do not interpolate from the previous world position, e.g. after a teleport</param>
+		void setLocal(TransformId id, const glm::mat4& local, bool snap = false)
+		{
+			const uint32_t slot = m_id_to_slot[id];
+			m_nodes[slot].local = local;
+			m_states[slot].local_dirty = 1;
+			m_states[slot].snap |= snap ? 1 : 0;
+		}
+
+		/// <summary>
+		/// Recompute the world matrices of dirty nodes and their descendants
+		/// </summary>
+		void update();
+
+		/// <summary>
+		/// World matrix from the last update. The translation is interpolated for nodes that moved
+		/// in it, alpha 0 is the previous world position and 1 the current one.
+		/// </summary>
+		glm::mat4 getWorld(TransformId id, float alpha = 1.0f) const;
+
+		/// <summary>
+		/// Current local matrix combined with the parent's world matrix from the last update. Used
+		/// when a local change has to be seen before the next update, such as refreshing bounds.
+		/// </summary>
+		glm::mat4 evaluateWorld(TransformId id) const;
+
+		/// <summary>
+		/// Ids whose world matrix changed in the last update, parents before children
+		/// </summary>
+		const std::vector<TransformId>& getChanged() const
+		{
+			return m_changed;
+		}
+
+		uint32_t getUserData(TransformId id) const
+		{
+			return m_nodes[m_id_to_slot[id]].user_data;
+		}
+
+		size_t getCount() const
+		{
+			return m_nodes.size() - m_removed_count;
+		}
+
+		void clear();
+
+	private:
+		static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+		struct Node {
+			glm::mat4 local{ 1.0f };
+			glm::mat4 world{ 1.0f };
+			glm::vec3 previous_translation{};
+			TransformId id{};
+			uint32_t user_data{};
+		};
+
+		// Everything the update pass reads for nodes it skips, kept apart so the pass streams
+		// through a few bytes per node instead of the matrices
+		struct NodeState {
+			uint32_t parent{ NONE };     // Slot of the parent, always lower than this slot
+			uint32_t changed_pass{};     // Last update that recomputed the world matrix
+			uint8_t local_dirty{};
+			uint8_t snap{};
+			uint8_t removed{};           // Destroyed, dropped by the next compaction
+		};
+
+		void link(TransformId id, TransformId parent);
+		void unlink(TransformId id);
+		void compact();
+		void rebuildOrder();
+
+		std::vector<Node> m_nodes;              // Topologically sorted
+		std::vector<NodeState> m_states;        // Per slot, same order as m_nodes
+		std::vector<TransformId> m_parent_ids;  // Per id, kept while the order is stale
+		std::vector<uint32_t> m_id_to_slot;
+
+		// Per id child lists, so orphaning and reordering only visit actual children
+		std::vector<TransformId> m_first_child;
+		std::vector<TransformId> m_next_sibling;
+		std::vector<TransformId> m_previous_sibling;
+
+		std::vector<TransformId> m_free_ids;
+		std::vector<TransformId> m_changed;
+		uint32_t m_pass{ 1 };
+		uint32_t m_removed_count{};
+		bool m_order_dirty{};
+
+		// Scratch for rebuildOrder
+		std::vector<Node> m_sorted;
+		std::vector<NodeState> m_sorted_states;
+
+	}; // end class
+}; // end namespace
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <glad/glad.h>
+#include "stream_buffer.hpp"
+
+namespace Xplor
+{
+	/// <summary>
+	/// Uniform data streamed every frame. Each push lands at the driver's uniform buffer offset
+	/// alignment inside the current frame region of a StreamBuffer, and each draw binds its
+	/// slice with glBindBufferRange.
+	/// </summary>
+	class UniformRing
+	{
+	public:
+		/// <summary>
+		/// Create the buffer. Requires a current OpenGL context.
+		/// </summary>
+		/// <param name="frame_size">Bytes available to each frame region, grows on demand</param>
+		void init(size_t frame_size);
+
+		void destroy()
+		{
+			m_stream.destroy();
+		}
+
+		/// <summary>
+		/// Move to the next region, waiting for the GPU if it is still reading it
+		/// </summary>
+		void beginFrame()
+		{
+			m_stream.beginFrame();
+		}
+
+		/// <summary>
+		/// Copy data into the current frame region
+		/// </summary>
+		/// <returns>Byte offset of the data inside the current region</returns>
+		size_t push(const void* data, size_t size)
+		{
+			return m_stream.write(data, size, m_alignment);
+		}
+
+		template<typename T>
+		size_t push(const T& data)
+		{
+			return push(&data, sizeof(T));
+		}
+
+		/// <summary>
+		/// Make everything pushed this frame visible. Must be called before any draw reads the ring.
+		/// </summary>
+		void flush()
+		{
+			m_stream.flush();
+		}
+
+		/// <summary>
+		/// Fence the current region so it is not overwritten while the GPU reads it
+		/// </summary>
+		void endFrame()
+		{
+			m_stream.endFrame();
+		}
+
+		/// <summary>
+		/// Bytes pushed into the current region
+		/// </summary>
+		size_t getUsedSize() const
+		{
+			return m_stream.getUsedSize();
+		}
+
+		/// <summary>
+		/// Bind a slice of the current region returned by push()
+		/// </summary>
+		void bindRange(GLuint binding, size_t offset, size_t size) const
+		{
+			size_t region_offset = m_stream.getRegionOffset() + offset;
+			glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_stream.getBuffer(), static_cast<GLintptr>(region_offset), static_cast<GLsizeiptr>(size));
+		}
+
+		size_t getAlignment() const
+		{
+			return m_alignment;
+		}
+
+	private:
+		StreamBuffer m_stream;
+		size_t m_alignment{ 256 };
+
+	}; // end class
+}; // end namespace
@@ -86,6 +86,7 @@ private:
 	GLFWwindow* m_window{};
 	float m_cursorOffsetX{}, m_cursorOffsetY{};
 	bool m_activeMouse{};
+	bool m_capture_key_down{};
 	float m_FOV = 90.0f;
 	
 
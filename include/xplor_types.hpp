@@ -47,6 +47,43 @@ namespace Xplor {
 	struct BoundingBox {
 		glm::vec3 min;
 		glm::vec3 max;
+
+		glm::vec3 getCenter() const
+		{
+			return (min + max) * 0.5f;
+		}
+
+		glm::vec3 getExtent() const
+		{
+			return (max - min) * 0.5f;
+		}
+
+		bool intersects(const BoundingBox& other) const
+		{
+			return min.x <= other.max.x && other.min.x <= max.x &&
+				min.y <= other.max.y && other.min.y <= max.y &&
+				min.z <= other.max.z && other.min.z <= max.z;
+		}
+
+		/// <summary>
+		/// Box around this box after an affine transform. The centre is transformed as a point and the
+		/// extent by the absolute linear part, which gives the tightest box without visiting the corners.
+		/// </summary>
+		BoundingBox transformed(const glm::mat4& transform) const
+		{
+			const glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+			const glm::vec3 extent = getExtent();
+			const glm::vec3 world_extent =
+				glm::abs(glm::vec3(transform[0])) * extent.x +
+				glm::abs(glm::vec3(transform[1])) * extent.y +
+				glm::abs(glm::vec3(transform[2])) * extent.z;
+			return { center - world_extent, center + world_extent };
+		}
+	};
+
+	struct BoundingSphere {
+		glm::vec3 center;
+		float radius;
 	};
 
 	struct Ray {
@@ -55,4 +92,94 @@ namespace Xplor {
 		glm::vec3 direction_inv;
 	};
 
+	// View frustum as six inward facing planes (xyz normal, w distance)
+	struct Frustum {
+		glm::vec4 planes[6];
+
+		/// <summary>
+		/// Extract the planes from a combined projection * view matrix
+		/// </summary>
+		static Frustum FromMatrix(const glm::mat4& view_projection)
+		{
+			// Rows of the matrix, glm is column major
+			glm::vec4 rows[4];
+			for (int i = 0; i < 4; i++)
+			{
+				rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+			}
+
+			Frustum frustum;
+			frustum.planes[0] = rows[3] + rows[0]; // Left
+			frustum.planes[1] = rows[3] - rows[0]; // Right
+			frustum.planes[2] = rows[3] + rows[1]; // Bottom
+			frustum.planes[3] = rows[3] - rows[1]; // Top
+			frustum.planes[4] = rows[3] + rows[2]; // Near
+			frustum.planes[5] = rows[3] - rows[2]; // Far
+
+			// Unit normals so plane distances are real distances for the sphere test
+			for (auto& plane : frustum.planes)
+			{
+				plane /= glm::length(glm::vec3(plane));
+			}
+			return frustum;
+		}
+
+		/// <summary>
+		/// Conservative test, only rejects boxes completely outside one of the planes
+		/// </summary>
+		bool intersects(const BoundingBox& box) const
+		{
+			for (const auto& plane : planes)
+			{
+				// Corner of the box furthest along the plane normal
+				glm::vec3 positive(
+					plane.x >= 0.0f ? box.max.x : box.min.x,
+					plane.y >= 0.0f ? box.max.y : box.min.y,
+					plane.z >= 0.0f ? box.max.z : box.min.z);
+
+				if (plane.x * positive.x + plane.y * positive.y + plane.z * positive.z + plane.w < 0.0f)
+					return false;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Cheaper than the box test, used to reject objects before looking at their box
+		/// </summary>
+		bool intersects(const BoundingSphere& sphere) const
+		{
+			for (const auto& plane : planes)
+			{
+				if (plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w < -sphere.radius)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// Uniform block binding points shared by every shader program
+	enum class UniformBinding : uint32_t
+	{
+		Camera = 0,
+		Object = 1,
+		Material = 2
+	};
+
+	// Matches the std140 CameraBlock in the shaders, written once per frame
+	struct CameraUniforms {
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 view_projection;
+		glm::vec4 position;
+	};
+
+	// Matches the std140 ObjectBlock in the shaders, written once per draw
+	struct ObjectUniforms {
+		glm::mat4 model;
+		glm::mat4 normal_matrix; // mat3 padded to std140 columns
+		int32_t object_id;
+		int32_t material_index;
+		int32_t padding[2];
+	};
+
 }; // end namespace
\ No newline at end of file
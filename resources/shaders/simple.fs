@@ -5,7 +5,10 @@ out vec4 FragColor;
 in vec3 ourColor;
 in vec2 texCoords1;
 
-uniform vec4 customColor;
+layout (std140) uniform MaterialBlock
+{
+    vec4 customColor; // Tint mixed over the texture by its alpha
+};
 uniform sampler2D customTexture1; // RGB
 uniform sampler2D customTexture2; // Transparent
 
@@ -16,10 +19,12 @@ void main()
     vec4 color2 = texture(customTexture2, texCoords1);
 
     // Output color is a weighted sum using the alpha from color 2
-    FragColor = mix (
+    vec4 color = mix (
         color1,
         color2,
         color2.a
     );
 
+    FragColor = mix(color, vec4(customColor.rgb, color.a), customColor.a);
+
 }
\ No newline at end of file
@@ -11,12 +11,23 @@ uniform mat4 transform;
 uniform mat4 liveTransform;
 
 // Coordinate Spaces
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform CameraBlock
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPosition;
+};
+
+layout (std140) uniform ObjectBlock
+{
+    mat4 model;
+    mat4 normalMatrix;
+    ivec4 objectInfo; // x: object id, y: material index
+};
 
 void main()
 {
    gl_Position = projection * view * model * vec4(aPos, 1.0f);
    texCoords1 = aTexCoord;
-}
\ No newline at end of file
+}
@@ -5,7 +5,10 @@ out vec4 FragColor;
 in vec3 ourColor;
 in vec2 texCoords1;
 
-uniform vec4 customColor;
+layout (std140) uniform MaterialBlock
+{
+    vec4 customColor; // Tint mixed over the texture by its alpha
+};
 uniform sampler2D customTexture1; // RGB
 
 
@@ -13,5 +16,5 @@ void main()
 {
     vec4 color1 = texture(customTexture1, texCoords1);
 
-    FragColor = color1;
+    FragColor = mix(color1, vec4(customColor.rgb, color1.a), customColor.a);
 }
\ No newline at end of file
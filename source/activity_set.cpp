@@ -0,0 +1,76 @@
+#include "activity_set.hpp"
+
+#include <cassert>
+
+namespace Xplor
+{
+	void ActivitySet::add(uint32_t index)
+	{
+		if (index >= m_slots.size())
+			m_slots.resize(index + 1, REMOVED);
+		assert(m_slots[index] == REMOVED && "Adding an object that is already tracked");
+		m_slots[index] = INACTIVE;
+		m_object_count++;
+		activate(index);
+	}
+
+	void ActivitySet::remove(uint32_t index)
+	{
+		if (index >= m_slots.size() || m_slots[index] == REMOVED)
+			return;
+
+		sleep(index);
+		m_slots[index] = REMOVED;
+		m_object_count--;
+	}
+
+	void ActivitySet::clear()
+	{
+		m_active.clear();
+		m_slots.clear();
+		m_object_count = 0;
+		std::lock_guard<std::mutex> lock(m_wake_mutex);
+		m_woken.clear();
+	}
+
+	void ActivitySet::wake(uint32_t index)
+	{
+		std::lock_guard<std::mutex> lock(m_wake_mutex);
+		m_woken.push_back(index);
+	}
+
+	void ActivitySet::beginTick()
+	{
+		std::lock_guard<std::mutex> lock(m_wake_mutex);
+		for (uint32_t index : m_woken)
+		{
+			if (index < m_slots.size())
+				activate(index);
+		}
+		m_woken.clear();
+	}
+
+	void ActivitySet::activate(uint32_t index)
+	{
+		// Already active, or removed since it was woken
+		if (m_slots[index] != INACTIVE)
+			return;
+
+		m_slots[index] = static_cast<uint32_t>(m_active.size());
+		m_active.push_back(index);
+	}
+
+	void ActivitySet::sleep(uint32_t index)
+	{
+		uint32_t slot = m_slots[index];
+		if (slot == INACTIVE || slot == REMOVED)
+			return;
+
+		// Swap remove, the last active object takes the free slot
+		uint32_t last = m_active.back();
+		m_active[slot] = last;
+		m_slots[last] = slot;
+		m_active.pop_back();
+		m_slots[index] = INACTIVE;
+	}
+}
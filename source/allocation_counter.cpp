@@ -0,0 +1,71 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Xplor
+{
+	namespace
+	{
+		std::atomic<uint64_t> g_allocation_count{ 0 };
+	}
+
+	uint64_t GetHeapAllocationCount()
+	{
+		return g_allocation_count.load(std::memory_order_relaxed);
+	}
+}
+
+#if XPLOR_ALLOCATION_COUNTER
+
+// The array and nothrow forms forward to these in every standard library we build with
+void* operator new(std::size_t size)
+{
+	Xplor::g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	if (void* data = std::malloc(size ? size : 1))
+		return data;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	Xplor::g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+	size = size ? size : 1;
+#ifdef _MSC_VER
+	void* data = _aligned_malloc(size, static_cast<std::size_t>(alignment));
+#else
+	// aligned_alloc wants the size to be a multiple of the alignment
+	const std::size_t align = static_cast<std::size_t>(alignment);
+	void* data = std::aligned_alloc(align, (size + align - 1) & ~(align - 1));
+#endif
+	if (data)
+		return data;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept
+{
+	std::free(data);
+}
+
+void operator delete(void* data, std::size_t) noexcept
+{
+	std::free(data);
+}
+
+void operator delete(void* data, std::align_val_t) noexcept
+{
+#ifdef _MSC_VER
+	_aligned_free(data);
+#else
+	std::free(data);
+#endif
+}
+
+void operator delete(void* data, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(data, alignment);
+}
+
+#endif
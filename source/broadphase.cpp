@@ -0,0 +1,282 @@
+#include "broadphase.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace Xplor
+{
+	namespace
+	{
+		// Ties put min endpoints first so touching boxes count as overlapping, matching overlaps()
+		inline bool EndpointLess(float value_a, uint32_t data_a, float value_b, uint32_t data_b)
+		{
+			if (value_a != value_b)
+				return value_a < value_b;
+			return !(data_a & 1) && (data_b & 1);
+		}
+
+		// Rebuild from scratch instead of sliding new endpoints in one by one once this share of the proxies is new
+		constexpr size_t REBUILD_DIVISOR = 4;
+	}
+
+	uint32_t SweepAndPrune::createProxy(const BoundingBox& bounds, uint32_t user_data)
+	{
+		uint32_t proxy;
+		if (!m_free_proxies.empty())
+		{
+			proxy = m_free_proxies.back();
+			m_free_proxies.pop_back();
+			m_proxies[proxy] = { bounds, user_data, true };
+		}
+		else
+		{
+			proxy = static_cast<uint32_t>(m_proxies.size());
+			m_proxies.push_back({ bounds, user_data, true });
+		}
+
+		// Appended at the end, the next update sorts them into place
+		for (auto& endpoints : m_axes)
+		{
+			endpoints.push_back({ 0.0f, proxy << 1 });
+			endpoints.push_back({ 0.0f, (proxy << 1) | 1 });
+		}
+		m_created_count++;
+
+		return proxy;
+	}
+
+	void SweepAndPrune::destroyProxy(uint32_t proxy)
+	{
+		if (proxy >= m_proxies.size() || !m_proxies[proxy].alive)
+		{
+			assert(false && "Destroying a broadphase proxy that does not exist");
+			return;
+		}
+
+		// Endpoints and pairs are removed in bulk by the next update
+		m_proxies[proxy].alive = false;
+		m_destroyed_proxies.push_back(proxy);
+	}
+
+	void SweepAndPrune::clear()
+	{
+		m_proxies.clear();
+		m_free_proxies.clear();
+		m_destroyed_proxies.clear();
+		m_created_count = 0;
+		for (auto& endpoints : m_axes)
+		{
+			endpoints.clear();
+		}
+		m_pairs.clear();
+		m_pair_lookup.clear();
+		m_begin_pairs.clear();
+		m_persist_pairs.clear();
+		m_end_pairs.clear();
+	}
+
+	bool SweepAndPrune::overlaps(uint32_t a, uint32_t b) const
+	{
+		const BoundingBox& box_a = m_proxies[a].bounds;
+		const BoundingBox& box_b = m_proxies[b].bounds;
+		return box_a.min.x <= box_b.max.x && box_b.min.x <= box_a.max.x &&
+			box_a.min.y <= box_b.max.y && box_b.min.y <= box_a.max.y &&
+			box_a.min.z <= box_b.max.z && box_b.min.z <= box_a.max.z;
+	}
+
+	void SweepAndPrune::addPair(uint32_t a, uint32_t b)
+	{
+		auto [it, inserted] = m_pair_lookup.try_emplace(PairKey(a, b), static_cast<uint32_t>(m_pairs.size()));
+		if (inserted)
+			m_pairs.push_back({ a, b, true, false });
+		else
+			m_pairs[it->second].overlapping = true;
+	}
+
+	void SweepAndPrune::removePair(uint32_t a, uint32_t b)
+	{
+		auto it = m_pair_lookup.find(PairKey(a, b));
+		if (it != m_pair_lookup.end())
+			m_pairs[it->second].overlapping = false;
+	}
+
+	void SweepAndPrune::removeDestroyedProxies()
+	{
+		if (m_destroyed_proxies.empty())
+			return;
+
+		for (auto& endpoints : m_axes)
+		{
+			endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [this](const Endpoint& endpoint) {
+				return !m_proxies[endpoint.data >> 1].alive;
+			}), endpoints.end());
+		}
+
+		for (auto& pair : m_pairs)
+		{
+			if (!m_proxies[pair.proxy_a].alive || !m_proxies[pair.proxy_b].alive)
+				pair.overlapping = false;
+		}
+	}
+
+	void SweepAndPrune::sortAxis(uint32_t axis)
+	{
+		std::vector<Endpoint>& endpoints = m_axes[axis];
+
+		for (auto& endpoint : endpoints)
+		{
+			const BoundingBox& bounds = m_proxies[endpoint.data >> 1].bounds;
+			endpoint.value = (endpoint.data & 1) ? bounds.max[axis] : bounds.min[axis];
+		}
+
+		// Insertion sort, each swap is a change of the overlap state on this axis
+		for (size_t i = 1; i < endpoints.size(); i++)
+		{
+			const Endpoint key = endpoints[i];
+			const uint32_t key_proxy = key.data >> 1;
+			const bool key_is_max = key.data & 1;
+
+			size_t j = i;
+			while (j > 0 && EndpointLess(key.value, key.data, endpoints[j - 1].value, endpoints[j - 1].data))
+			{
+				const Endpoint& other = endpoints[j - 1];
+				const uint32_t other_proxy = other.data >> 1;
+				const bool other_is_max = other.data & 1;
+
+				if (key_proxy != other_proxy)
+				{
+					// A min moving below a max starts an overlap on this axis, the other axes decide the rest
+					if (!key_is_max && other_is_max)
+					{
+						if (overlaps(key_proxy, other_proxy))
+							addPair(key_proxy, other_proxy);
+					}
+					// A max moving below a min separates the boxes
+					else if (key_is_max && !other_is_max)
+					{
+						removePair(key_proxy, other_proxy);
+					}
+				}
+
+				endpoints[j] = other;
+				j--;
+				m_swap_count++;
+			}
+			endpoints[j] = key;
+		}
+	}
+
+	void SweepAndPrune::rebuild()
+	{
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			std::vector<Endpoint>& endpoints = m_axes[axis];
+			for (auto& endpoint : endpoints)
+			{
+				const BoundingBox& bounds = m_proxies[endpoint.data >> 1].bounds;
+				endpoint.value = (endpoint.data & 1) ? bounds.max[axis] : bounds.min[axis];
+			}
+			std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) {
+				return EndpointLess(a.value, a.data, b.value, b.data);
+			});
+		}
+
+		// Pairs still overlapping are found again below, the rest end
+		for (auto& pair : m_pairs)
+		{
+			pair.overlapping = false;
+		}
+
+		// One sweep along x, boxes whose x intervals are open at the same time are candidates
+		std::vector<uint32_t> active;
+		std::vector<uint32_t> active_slot(m_proxies.size());
+		for (const Endpoint& endpoint : m_axes[0])
+		{
+			const uint32_t proxy = endpoint.data >> 1;
+			if (endpoint.data & 1)
+			{
+				// Swap remove from the active list
+				uint32_t slot = active_slot[proxy];
+				active[slot] = active.back();
+				active_slot[active[slot]] = slot;
+				active.pop_back();
+			}
+			else
+			{
+				for (uint32_t other : active)
+				{
+					if (overlaps(proxy, other))
+						addPair(proxy, other);
+				}
+				active_slot[proxy] = static_cast<uint32_t>(active.size());
+				active.push_back(proxy);
+			}
+		}
+	}
+
+	void SweepAndPrune::reportPairs()
+	{
+		m_begin_pairs.clear();
+		m_persist_pairs.clear();
+		m_end_pairs.clear();
+
+		for (size_t i = 0; i < m_pairs.size();)
+		{
+			OverlapPair& pair = m_pairs[i];
+			uint32_t user_a = m_proxies[pair.proxy_a].user_data;
+			uint32_t user_b = m_proxies[pair.proxy_b].user_data;
+			BroadphasePair reported{ std::min(user_a, user_b), std::max(user_a, user_b) };
+
+			if (pair.overlapping)
+			{
+				if (pair.was_overlapping)
+					m_persist_pairs.push_back(reported);
+				else
+					m_begin_pairs.push_back(reported);
+
+				pair.was_overlapping = true;
+				i++;
+				continue;
+			}
+
+			if (pair.was_overlapping)
+				m_end_pairs.push_back(reported);
+
+			// Drop separated pairs, the last pair takes the free slot
+			m_pair_lookup.erase(PairKey(pair.proxy_a, pair.proxy_b));
+			if (i != m_pairs.size() - 1)
+			{
+				pair = m_pairs.back();
+				m_pair_lookup[PairKey(pair.proxy_a, pair.proxy_b)] = static_cast<uint32_t>(i);
+			}
+			m_pairs.pop_back();
+		}
+	}
+
+	void SweepAndPrune::update()
+	{
+		m_swap_count = 0;
+		removeDestroyedProxies();
+
+		// Sliding a few new proxies into place is cheap, a scene load is not
+		const size_t proxy_count = getProxyCount();
+		if (m_created_count > 0 && m_created_count * REBUILD_DIVISOR > proxy_count)
+		{
+			rebuild();
+		}
+		else
+		{
+			for (uint32_t axis = 0; axis < 3; axis++)
+			{
+				sortAxis(axis);
+			}
+		}
+		m_created_count = 0;
+
+		reportPairs();
+
+		// The user data of destroyed proxies was needed for their end events
+		m_free_proxies.insert(m_free_proxies.end(), m_destroyed_proxies.begin(), m_destroyed_proxies.end());
+		m_destroyed_proxies.clear();
+	}
+}
@@ -0,0 +1,73 @@
+#include "debug_draw.hpp"
+#include "generator_geometry.hpp"
+
+#include <cstring>
+
+namespace Xplor
+{
+	void DebugDraw::init()
+	{
+		glGenVertexArrays(1, &m_VAO);
+		// Room for a few thousand boxes per frame before the buffer has to grow
+		m_stream.init(GL_ARRAY_BUFFER, 256 * 1024, VERTEX_STRIDE);
+	}
+
+	void DebugDraw::destroy()
+	{
+		m_stream.destroy();
+		if (m_VAO)
+		{
+			glDeleteVertexArrays(1, &m_VAO);
+			m_VAO = 0;
+		}
+	}
+
+	void DebugDraw::beginFrame()
+	{
+		m_stream.beginFrame();
+		m_vertex_count = 0;
+	}
+
+	void DebugDraw::addLine(const glm::vec3& start, const glm::vec3& end)
+	{
+		const float vertices[6] = { start.x, start.y, start.z, end.x, end.y, end.z };
+		m_stream.write(vertices, sizeof(vertices), VERTEX_STRIDE);
+		m_vertex_count += 2;
+	}
+
+	void DebugDraw::addBox(const BoundingBox& box)
+	{
+		auto vertices = GeometryGenerator::GenerateBoundingBoxLines(box.min, box.max);
+		m_stream.write(vertices.data(), vertices.size() * sizeof(float), VERTEX_STRIDE);
+		m_vertex_count += vertices.size() / 3;
+	}
+
+	void DebugDraw::draw(const std::shared_ptr<Shader>& shader)
+	{
+		if (m_vertex_count == 0 || !shader)
+			return;
+
+		m_stream.flush();
+
+		// The stream buffer may have been recreated when it grew and the region moves every
+		// frame, so the attribute is pointed at the current region each time
+		glBindVertexArray(m_VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, m_stream.getBuffer());
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_STRIDE, reinterpret_cast<GLvoid*>(m_stream.getRegionOffset()));
+		glEnableVertexAttribArray(0);
+
+		shader->useProgram();
+		glLineWidth(10.0f);
+		glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(m_vertex_count));
+		glLineWidth(1.0f); // restore line width
+		shader->endProgram();
+
+		glBindVertexArray(0); // unbind VAO
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void DebugDraw::endFrame()
+	{
+		m_stream.endFrame();
+	}
+}
@@ -7,6 +7,14 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <shader_manager.hpp>
+#include <job_system.hpp>
+#include <allocation_counter.hpp>
+#include <log.hpp>
+#include <profiler.hpp>
+#include <stats.hpp>
+#include <algorithm>
+#include <iterator>
+#include <cmath>
 
 
 std::shared_ptr<Xplor::EngineManager> Xplor::EngineManager::m_instance = nullptr;
@@ -26,6 +34,9 @@ void Xplor::EngineManager::createWindow(int width, int height, bool fullscreen)
     windowManager->SetMouseCallbacks();
 	windowManager->CaptureCursor(GLFW_CURSOR_NORMAL);
 
+    // GPU resources used every frame
+    m_renderer.init();
+
 }
 
 void Xplor::EngineManager::createCamera(CameraVectors vectors, float speed, float fov)
@@ -53,39 +64,34 @@ bool Xplor::EngineManager::run()
     RebuildFontAtlas(fontSize);
 
     auto window_manager = WindowManager::GetInstance();
-    while (!glfwWindowShouldClose(window_manager->GetWindow())) // Need to setup my own events for this to work better
+    GLFWwindow* window = window_manager->GetWindow();
+
+    // Hand the OpenGL context to the render thread, simulation stays on this thread
+    if (m_threaded_rendering)
+        m_render_thread.start(window, &m_renderer);
+
+    if (m_frame_graph.getTaskCount() == 0)
+        buildFrameGraph();
+
+    XPLOR_PROFILE_THREAD("Main");
+
+    bool first_frame = true;
+    while (!glfwWindowShouldClose(window)) // Need to setup my own events for this to work better
     {
+        // Frame boundary for trace captures, before the frame's own scope opens
+        Profiler::endFrame();
+        XPLOR_PROFILE_SCOPE("Frame");
+
         //--- Update Delta Time
         float current_frame_time = static_cast<float>(glfwGetTime());
         float delta_time = current_frame_time - m_last_frame_time;
         m_delta_time = delta_time;
         m_last_frame_time = current_frame_time;
 
-
-        //--- Input
-        //-----------------------------------------------------
-        window_manager->PollEvents();
-        //float cameraFinalSpeed = m_activeCamera->m_speed * deltaTime;
-
-        // I need to change how this logic happens. The window manager should process the inputs here
-        // but then after that it should let the camera know if it needs to move
-        //windowManager->ProcessInputs(cameraPosition, cameraFront, cameraUp, cameraFinalSpeed);
-
-        //--- ImGui
-        window_manager->NewImguiFrame();
-
-        window_manager->CreateEditorUI();
-
-        // Rendering commands
-        //-----------------------------------------------------
-
-        //---- Background Color
-        glClearColor(0.1f, 0.3f, 0.5f, 1.0f);
-        glClearColor(window_manager->m_clear_color.x * window_manager->m_clear_color.w,
-            window_manager->m_clear_color.y * window_manager->m_clear_color.w,
-            window_manager->m_clear_color.z * window_manager->m_clear_color.w,
-            window_manager->m_clear_color.w);
-        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+        // The time since the last loop closes the previous frame's counters, the first one has no frame behind it
+        if (!first_frame)
+            Stats::endFrame(delta_time * 1000.0f);
+        first_frame = false;
 
         //---- Logic Commands
         static bool move = true;
@@ -101,55 +107,435 @@ bool Xplor::EngineManager::run()
             m_gameObjects[2]->SetRotation(glm::vec3(1.0f, 0.0f, 0.0f), 45.f);
         }*/
 
-        //--- Logic Update
-        update(delta_time);
+        //--- Input, simulation, culling, UI and submission as declared in buildFrameGraph
+        m_frame_arena.reset();
+        const uint64_t allocations = GetHeapAllocationCount();
+        m_frame_graph.execute();
+        m_frame_allocations = GetHeapAllocationCount() - allocations;
+        Stats::add(Stat::HeapAllocations, m_frame_allocations);
+
+        // Check for window font resizing
+        /*fontSize = 20;
+        RebuildFontAtlas(fontSize);*/
+    }
+
+    // Finish the last frame, free the renderer's GPU resources on the thread owning the context
+    // and take the context back for cleanup and export
+    m_render_thread.waitIdle();
+    m_render_thread.runOnRenderThread([this]() { m_renderer.shutdown(); });
+    m_render_thread.stop();
+
+	return false;
+}
 
-        //---- Scene Rendering
-        render(m_active_camera->m_view_matrix, m_active_camera->m_projection_matrix);
+/// <summary>
+/// Declare the stages of a frame. Stages only wait on what they actually read, everything
+/// else runs in parallel on the job system. Stages touching GLFW or ImGui stay on the main thread.
+/// </summary>
+void Xplor::EngineManager::buildFrameGraph()
+{
+    auto window_manager = WindowManager::GetInstance();
+    GLFWwindow* window = window_manager->GetWindow();
 
-        //---- ImGui Rendering
+    //--- Input, mouse callbacks may spawn objects so simulation waits for it
+    auto input = m_frame_graph.addTask("Input", [window_manager]() {
+        window_manager->PollEvents();
+    }, {}, true);
+
+    // Camera input is read through GLFW which is main thread only
+    auto camera = m_frame_graph.addTask("Camera Update", [this]() {
+        m_active_camera->Update(m_delta_time);
+    }, { input }, true);
+
+    // Zero or more fixed ticks of update, bounds refit and broadphase
+    auto simulation = m_frame_graph.addTask("Simulation", [this]() {
+        simulate(m_delta_time);
+    }, { input });
+
+    auto culling = m_frame_graph.addTask("Culling", [this]() {
+        cullObjects(m_active_camera->m_projection_matrix * m_active_camera->m_view_matrix);
+    }, { camera, simulation });
+
+    // Blocks only if the render thread is still drawing the packet from two frames ago. Waiting
+    // on the main thread right before the draw list needs it keeps the workers free meanwhile.
+    auto acquire = m_frame_graph.addTask("Acquire Packet", [this]() {
+        m_current_packet = m_render_thread.isRunning() ? &m_render_thread.acquirePacket() : &m_packet;
+        // The packet was drawn, its counts are reported as a whole so a frame never mixes two packets
+        Stats::addPacket(m_current_packet->render_stats);
+        m_current_packet->clear();
+    }, { culling }, true);
+
+    auto draw_list = m_frame_graph.addTask("Draw List Build", [this]() {
+        render(m_active_camera->m_view_matrix, m_active_camera->m_projection_matrix, *m_current_packet);
+    }, { acquire });
+
+    // The editor reads object state, so it waits for simulation to finish
+    auto ui = m_frame_graph.addTask("UI", [window_manager]() {
+        window_manager->NewImguiFrame();
+        window_manager->CreateEditorUI();
         ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window_manager->GetWindow(), &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }, { input, simulation }, true);
 
+    m_frame_graph.addTask("Submit", [this, window_manager, window]() {
+        FramePacket& packet = *m_current_packet;
 
-        // Swap the front and back buffers
-        window_manager->UpdateBuffers();
+        //---- Background Color
+        packet.clear_color = glm::vec4(window_manager->m_clear_color.x * window_manager->m_clear_color.w,
+            window_manager->m_clear_color.y * window_manager->m_clear_color.w,
+            window_manager->m_clear_color.z * window_manager->m_clear_color.w,
+            window_manager->m_clear_color.w);
+        glfwGetFramebufferSize(window, &packet.framebuffer_width, &packet.framebuffer_height);
+        packet.captureUI(ImGui::GetDrawData());
 
-        // Check for window font resizing
-        /*fontSize = 20;
-        RebuildFontAtlas(fontSize);*/
+        // Objects removed since the last submit may still be drawn by this packet or the one before
+        // it, which is drawn first. Their buffers go once this packet was drawn, on the render thread.
+        if (!m_released_objects.empty())
+        {
+            packet.deferred.push_back([objects = std::move(m_released_objects)]() {
+                for (const auto& object : objects)
+                {
+                    object->Delete();
+                }
+            });
+            m_released_objects = {};
+        }
+
+        if (m_render_thread.isRunning())
+        {
+            m_render_thread.submit();
+        }
+        else
+        {
+            m_renderer.execute(packet, packet.render_stats);
+            packet.runDeferred();
+            // Swap the front and back buffers
+            window_manager->UpdateBuffers();
+        }
+    }, { draw_list, ui }, true);
+}
+
+
+void Xplor::EngineManager::simulate(float frame_time)
+{
+    const float step = 1.0f / m_tick_rate;
+    m_accumulator += frame_time;
+
+    uint32_t ticks = 0;
+    while (m_accumulator >= step && ticks < m_max_ticks_per_frame)
+    {
+        fixedUpdate(step);
+        m_accumulator -= step;
+        ticks++;
     }
 
-	return false;
+    // Too far behind to catch up, drop the backlog rather than spending even longer next frame
+    if (m_accumulator >= step)
+        m_accumulator = std::fmod(m_accumulator, step);
+
+    m_interpolation_alpha = m_accumulator / step;
 }
 
+void Xplor::EngineManager::fixedUpdate(float step)
+{
+    XPLOR_PROFILE_SCOPE("Fixed Update");
+    m_activity.beginTick();
+    if (!m_activity.getActive().empty())
+        m_scene_bvh_stale = true;
+    update(step);
+    updateTransforms();
+    updateBroadphase();
+    updateActivity();
+
+    // Nothing else reads the objects until the tick is over, so they can be removed here
+    m_simulation_time += step;
+    updateLifetimes();
+    processDespawns();
+}
 
 void Xplor::EngineManager::update(float deltaTime)
 {
-    m_active_camera->Update(deltaTime);
+    XPLOR_PROFILE_SCOPE("Update");
+    // Gather the awake objects into packed arrays, integrate them with the widest SIMD
+    // kernel available and scatter positions and bounds back. Objects only touch their
+    // own state and their own batch slots, so ranges run in parallel.
+    const std::vector<uint32_t>& active = m_activity.getActive();
+    Stats::add(Stat::ObjectsUpdated, active.size());
+    m_kinematics.resize(active.size());
+    JobSystem::getInstance()->parallelFor(active.size(), RECORD_BATCH_SIZE, [&](size_t begin, size_t end, uint32_t) {
+        for (size_t i = begin; i < end; i++)
+        {
+            objectAt(active[i]).writeKinematics(m_kinematics, i);
+        }
+
+        IntegrateKinematics(m_kinematics, deltaTime, begin, end);
+
+        for (size_t i = begin; i < end; i++)
+        {
+            GameObject& object = objectAt(active[i]);
+            if (object.readKinematics(m_kinematics, i))
+                m_broadphase.updateProxy(object.getBroadphaseProxy(), object.getBoundingBox());
+        }
+    });
+}
+
+void Xplor::EngineManager::updateTransforms()
+{
+    m_transforms.update();
+
+    const auto& changed = m_transforms.getChanged();
+    if (!changed.empty())
+        m_scene_bvh_stale = true;
+
+    // Roots already have their bounds from the integrator or their setters
+    for (TransformHierarchy::TransformId id : changed)
+    {
+        if (m_transforms.getParent(id) == TransformHierarchy::INVALID_TRANSFORM)
+            continue;
+
+        GameObject& object = objectAt(m_transforms.getUserData(id));
+        object.updateBoundingBox();
+        m_broadphase.updateProxy(object.getBroadphaseProxy(), object.getBoundingBox());
+        m_octree.updateProxy(object.getOctreeProxy(), object.getBoundingBox());
+    }
+}
+
+void Xplor::EngineManager::updateBroadphase()
+{
+    m_broadphase.update();
+
+    // Moving an octree proxy relinks nodes, so unlike the sweep and prune proxies this is serial.
+    // Most moves stay within their cell and only copy the bounds.
+    for (uint32_t slot : m_activity.getActive())
+    {
+        const GameObject& object = objectAt(slot);
+        m_octree.updateProxy(object.getOctreeProxy(), object.getBoundingBox());
+    }
+}
+
+void Xplor::EngineManager::updateActivity()
+{
+    for (const BroadphasePair& pair : m_broadphase.getBeginPairs())
+    {
+        objectAt(pair.a).wake();
+        objectAt(pair.b).wake();
+    }
+
+    // Backwards so the swap remove only moves objects already checked
+    const std::vector<uint32_t>& active = m_activity.getActive();
+    for (size_t i = active.size(); i-- > 0;)
+    {
+        uint32_t slot = active[i];
+        if (objectAt(slot).isSleeping())
+            m_activity.sleep(slot);
+    }
+}
+
+void Xplor::EngineManager::updateLifetimes()
+{
+    // Sleeping objects have not moved since they were last checked
+    for (uint32_t slot : m_activity.getActive())
+    {
+        const GameObject& object = objectAt(slot);
+        if (object.getDespawnOutsideWorld() && !m_world_bounds.intersects(object.getBoundingBox()))
+            m_despawning.push_back(object.getHandle());
+    }
+
+    // Expiries of objects removed early are stale handles and skipped by processDespawns
+    while (!m_expiries.empty() && m_expiries.front().time <= m_simulation_time)
+    {
+        std::pop_heap(m_expiries.begin(), m_expiries.end(), ExpiresLater);
+        m_despawning.push_back(m_expiries.back().handle);
+        m_expiries.pop_back();
+    }
+}
+
+void Xplor::EngineManager::processDespawns()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_despawn_mutex);
+        m_despawning.insert(m_despawning.end(), m_despawn_queue.begin(), m_despawn_queue.end());
+        m_despawn_queue.clear();
+    }
+
+    for (Handle handle : m_despawning)
+    {
+        // Null if queued twice, or removed directly since it was queued
+        std::shared_ptr<GameObject> object = detachGameObject(handle);
+        if (!object)
+            continue;
+
+        // Instances share the prefab's GPU resources and stay alive in the pool, everything
+        // else is released once the packets that may draw it were drawn
+        if (const GameObject* source = object->getPrefabSource().get())
+        {
+            m_object_pools[source].push_back(std::move(object));
+            m_pooled_object_count++;
+        }
+        else
+        {
+            m_released_objects.push_back(std::move(object));
+        }
+    }
+    m_despawning.clear();
+}
+
+void Xplor::EngineManager::despawn(Handle handle)
+{
+    std::lock_guard<std::mutex> lock(m_despawn_mutex);
+    m_despawn_queue.push_back(handle);
+}
+
+void Xplor::EngineManager::registerLifetime(const GameObject& object)
+{
+    const float time_to_live = object.getTimeToLive();
+    if (!std::isfinite(time_to_live))
+        return;
+
+    m_expiries.push_back({ m_simulation_time + time_to_live, object.getHandle() });
+    std::push_heap(m_expiries.begin(), m_expiries.end(), ExpiresLater);
+}
+
+void Xplor::EngineManager::registerActivity(uint32_t slot)
+{
+    m_activity.add(slot);
+    objectAt(slot).setActivitySet(&m_activity, slot);
+}
+
+void Xplor::EngineManager::registerBroadphase(uint32_t slot)
+{
+    GameObject& object = objectAt(slot);
+    object.setBroadphaseProxy(m_broadphase.createProxy(object.getBoundingBox(), slot));
+}
+
+void Xplor::EngineManager::registerTransform(uint32_t slot)
+{
+    GameObject& object = objectAt(slot);
+    object.setTransform(&m_transforms, m_transforms.create(slot, object.computeLocalMatrix()));
+}
+
+void Xplor::EngineManager::setParent(Handle child, Handle parent)
+{
+    GameObject* child_object = findObject(child);
+    if (!child_object)
+        return;
+
+    GameObject* parent_object = findObject(parent);
+    m_transforms.setParent(child_object->getTransform(), parent_object ? parent_object->getTransform() : TransformHierarchy::INVALID_TRANSFORM);
+    child_object->refreshTransform();
+}
 
-    for (auto object : m_gameObjects)
-    {               
-        object->update(deltaTime);
+void Xplor::EngineManager::registerOctree(uint32_t slot)
+{
+    GameObject& object = objectAt(slot);
+    object.setOctreeProxy(m_octree.createProxy(object.getBoundingBox(), slot));
+}
+
+void Xplor::EngineManager::cullObjects(const glm::mat4& view_projection)
+{
+    auto job_system = JobSystem::getInstance();
+    m_visible_lists.resize(std::max<size_t>(m_visible_lists.size(), job_system->getThreadCount()));
+    for (auto& list : m_visible_lists)
+    {
+        list.clear();
     }
 
+    // Only objects touching the view frustum make it into the packet
+    Frustum frustum = Frustum::FromMatrix(view_projection);
+    job_system->parallelFor(m_objects.size(), RECORD_BATCH_SIZE, [&](size_t begin, size_t end, uint32_t thread_index) {
+        auto& list = m_visible_lists[thread_index];
+        for (size_t i = begin; i < end; i++)
+        {
+            // The sphere test rejects most of the objects outside the view before the box test
+            const GameObject& object = *m_objects[i];
+            if (frustum.intersects(object.getBoundingSphere()) && frustum.intersects(object.getBoundingBox()))
+                list.push_back(m_objects.getSlot(i));
+        }
+    });
+
+    m_visible_objects.clear();
+    for (const auto& list : m_visible_lists)
+    {
+        m_visible_objects.insert(m_visible_objects.end(), list.begin(), list.end());
+    }
+    Stats::add(Stat::ObjectsVisible, m_visible_objects.size());
+    Stats::add(Stat::ObjectsCulled, m_objects.size() - m_visible_objects.size());
 }
 
-void Xplor::EngineManager::render(glm::mat4 view_matrix, glm::mat4 projection_matrix)
+void Xplor::EngineManager::render(const glm::mat4& view_matrix, const glm::mat4& projection_matrix, FramePacket& packet)
 {
+    XPLOR_PROFILE_SCOPE("Render");
     constexpr bool DEBUG = true;
-	for (auto object : m_gameObjects)
-	{
-		object->draw(view_matrix, projection_matrix);
-        if (DEBUG)
+
+    packet.camera.view = view_matrix;
+    packet.camera.projection = projection_matrix;
+    packet.camera.view_projection = projection_matrix * view_matrix;
+    packet.camera.position = glm::vec4(m_active_camera->m_vectors.camera_position, 1.0f);
+
+    // Every thread records into its own command list, no locking while recording
+    auto job_system = JobSystem::getInstance();
+    m_command_lists.resize(std::max<size_t>(m_command_lists.size(), job_system->getThreadCount()));
+    for (auto& list : m_command_lists)
+    {
+        list.draws.clear();
+        list.debug_boxes.clear();
+    }
+
+    // Record the objects that survived culling
+    job_system->parallelFor(m_visible_objects.size(), RECORD_BATCH_SIZE, [&](size_t begin, size_t end, uint32_t thread_index) {
+        RenderCommandList& list = m_command_lists[thread_index];
+        for (size_t i = begin; i < end; i++)
         {
-            object->drawBoundingBox(view_matrix, projection_matrix);
+            GameObject& object = objectAt(m_visible_objects[i]);
+            const BoundingBox& bbox = object.getBoundingBox();
+
+            DrawItem item;
+            if (object.getDrawItem(item, m_interpolation_alpha))
+                list.draws.push_back(item);
+
+            if (DEBUG)
+            {
+                list.debug_boxes.push_back(bbox);
+            }
         }
-            
-	}
+
+        // Sorted lists only need merging afterwards
+        std::sort(list.draws.begin(), list.draws.end(), DrawItemLess);
+    });
+
+    // Merge the sorted per-thread lists, grouping draws by program and material so state
+    // changes and uploads happen once per group. Merging in place would allocate a buffer,
+    // the merge passes ping-pong between two lists in the frame arena instead.
+    size_t draw_count = 0;
+    size_t box_count = 0;
+    for (const auto& list : m_command_lists)
+    {
+        draw_count += list.draws.size();
+        box_count += list.debug_boxes.size();
+    }
+
+    std::pmr::vector<DrawItem> merged(&m_frame_arena);
+    std::pmr::vector<DrawItem> next(&m_frame_arena);
+    merged.reserve(draw_count);
+    next.reserve(draw_count);
+    packet.debug_boxes.reserve(box_count);
+    for (const auto& list : m_command_lists)
+    {
+        next.clear();
+        std::merge(merged.begin(), merged.end(), list.draws.begin(), list.draws.end(), std::back_inserter(next), DrawItemLess);
+        merged.swap(next);
+        packet.debug_boxes.insert(packet.debug_boxes.end(), list.debug_boxes.begin(), list.debug_boxes.end());
+    }
+    packet.draws.assign(merged.begin(), merged.end());
+
+    // Draws are grouped by material, the packet keeps each one alive until it was drawn
+    const Material* previous = nullptr;
+    for (const DrawItem& item : packet.draws)
+    {
+        if (item.material == previous)
+            continue;
+        packet.materials.push_back(item.material->shared_from_this());
+        previous = item.material;
+    }
 }
 
 std::shared_ptr<Xplor::EngineManager> Xplor::EngineManager::GetInstance()
@@ -162,66 +548,175 @@ std::shared_ptr<Xplor::EngineManager> Xplor::EngineManager::GetInstance()
 	return m_instance;
 }
 
-void Xplor::EngineManager::addGameObject(std::shared_ptr<GameObject> object)
+Xplor::Handle Xplor::EngineManager::addGameObject(std::shared_ptr<GameObject> object)
 {
     object->setID(++m_objectCount);
-	m_gameObjects.push_back(object);
+    const Handle handle = m_objects.insert(object);
+    object->setHandle(handle);
+    registerTransform(handle.index);
+    registerBroadphase(handle.index);
+    registerOctree(handle.index);
+    registerActivity(handle.index);
+    registerLifetime(*object);
+    m_scene_bvh_rebuild = true;
+    return handle;
 }
 
-void Xplor::EngineManager::rayIntersectionTest(const Xplor::Ray& ray)
+bool Xplor::EngineManager::removeGameObject(Handle handle)
 {
-    float t; // depth
-    float closest_t = std::numeric_limits<float>::max();
-    std::shared_ptr<GameObject> closest_object = nullptr;
+    std::shared_ptr<GameObject> object = detachGameObject(handle);
+    if (!object)
+        return false;
 
-    for (const std::shared_ptr<GameObject>& object : m_gameObjects)
+    // Packets in flight may still draw the object, its GPU resources are released after them
+    m_released_objects.push_back(std::move(object));
+    return true;
+}
+
+std::shared_ptr<Xplor::GameObject> Xplor::EngineManager::detachGameObject(Handle handle)
+{
+    std::shared_ptr<GameObject>* entry = m_objects.get(handle);
+    if (!entry)
+        return nullptr;
+
+    std::shared_ptr<GameObject> object = std::move(*entry);
+
+    // Every system defers the actual work: broadphase proxies and transform slots are dropped
+    // in bulk by their next update, no matter how many objects went this tick. Broadphase end
+    // pairs for the object are reported next tick and may name the slot after it was reused,
+    // they are only informational.
+    m_broadphase.destroyProxy(object->getBroadphaseProxy());
+    m_octree.destroyProxy(object->getOctreeProxy());
+    m_transforms.destroy(object->getTransform());
+    m_activity.remove(handle.index);
+    object->setActivitySet(nullptr, 0);
+    object->setTransform(nullptr, TransformHierarchy::INVALID_TRANSFORM);
+    object->setHandle(Handle());
+
+    m_objects.remove(handle);
+
+    // The scene BVH keeps the item, it is shrunk and refitted instead of rebuilding the tree
+    m_scene_bvh_stale = true;
+    return object;
+}
+
+void Xplor::EngineManager::rayIntersectionTest(const Xplor::Ray& ray)
+{
+    PickHit hit;
+    if (pick(ray, hit))
     {
-        if (rayIntersectsAABB(ray, object->getBoundingBox(), t))
+        XPLOR_LOG_DEBUG(Scene, "Ray intersected object %u triangle %u at (%g, %g, %g) barycentrics (%g, %g, %g)",
+            findObject(hit.object)->getID(), hit.triangle, hit.point.x, hit.point.y, hit.point.z,
+            hit.barycentrics.x, hit.barycentrics.y, hit.barycentrics.z);
+    }
+}
+
+bool Xplor::EngineManager::pick(const Ray& ray, PickHit& out_hit)
+{
+    updateSceneBVH();
+
+    bool hit = false;
+    m_scene_bvh.traverse(ray, std::numeric_limits<float>::max(), [&](uint32_t item, float) {
+        // The visitor returns the closest distance so far, objects behind it are never visited
+        float max_t = hit ? out_hit.t : std::numeric_limits<float>::max();
+        const std::shared_ptr<GameObject>* entry = m_objects.get(m_scene_bvh_handles[item]);
+        if (!entry)
+            return max_t;
+        const GameObject* object = entry->get();
+        const auto& mesh = object->getMesh();
+        if (!mesh)
+            return max_t;
+
+        // The direction is transformed but not renormalised, so t is the same in both spaces
+        const glm::mat4 world_to_local = glm::inverse(object->computeModelMatrix());
+        Ray local_ray;
+        local_ray.origin = glm::vec3(world_to_local * glm::vec4(ray.origin, 1.0f));
+        local_ray.direction = glm::vec3(world_to_local * glm::vec4(ray.direction, 0.0f));
+        local_ray.direction_inv = 1.0f / local_ray.direction;
+
+        MeshHit mesh_hit;
+        if (mesh->intersect(local_ray, max_t, mesh_hit))
         {
-            std::cout << "Ray intersects object: " << object->getName() << " at t = " << t << std::endl;
-            if (t < closest_t)
-            {
-                closest_t = t;
-                closest_object = object;
-            }
-            // Add visual feedback, e.g., change object color
-            //object->SetColor(glm::vec3(1.0f, 0.0f, 0.0f)); // Assuming you have a SetColor method
+            out_hit.object = object->getHandle();
+            out_hit.triangle = mesh_hit.triangle;
+            out_hit.t = mesh_hit.t;
+            out_hit.point = ray.origin + ray.direction * mesh_hit.t;
+            out_hit.barycentrics = mesh_hit.barycentrics;
+            hit = true;
+            max_t = mesh_hit.t;
         }
-    }
+        return max_t;
+    });
 
-    if (closest_object)
-    {
-        std::cout << "Ray intersected the closest object: " << closest_object->getName() << std::endl;
-    }
+    return hit;
 }
 
-/// <summary>
-/// Check for the closest Bounding Box that is closest to the rays origin in a given direction
-/// </summary>
-/// <param name="ray_origin">Converted world coordinate of where cursor is clicked</param>
-/// <param name="ray_direction">The direction from the ray's start to where it terminates</param>
-/// <param name="bbox">Bounding box of a game object</param>
-/// <param name="out_t">Indicates the distance from the ray's origin to the intersection point along the ray's direction vector</param>
-/// <returns></returns>
-bool Xplor::EngineManager::rayIntersectsAABB(const Xplor::Ray & ray, const BoundingBox& bbox, float& out_t)
-{
-    float tmin = std::numeric_limits<float>::min();
-    float tmax = std::numeric_limits<float>::max();
-
-    // Go through each dimension (x, y, z)
-    for (int d = 0; d < 3; d++)
+void Xplor::EngineManager::raycast(const Ray* rays, size_t count, RaycastHit* out_hits)
+{
+    updateSceneBVH();
+
+    // Packets are formed inside each range, rays left over at its end go through the narrower kernels
+    m_ray_hits.resize(count);
+    JobSystem::getInstance()->parallelFor(count, RECORD_BATCH_SIZE, [&](size_t begin, size_t end, uint32_t) {
+        m_scene_bvh.intersect(rays + begin, end - begin, m_ray_hits.data() + begin);
+        for (size_t i = begin; i < end; i++)
+        {
+            const RayHit& hit = m_ray_hits[i];
+            // Removed items can not be hit, the check only guards against a rebuild racing ahead
+            out_hits[i].object = hit.object != RayHit::NO_HIT && m_objects.contains(m_scene_bvh_handles[hit.object]) ? m_scene_bvh_handles[hit.object] : Handle();
+            out_hits[i].t = hit.t;
+        }
+    });
+}
+
+void Xplor::EngineManager::updateSceneBVH()
+{
+    bool rebuild = m_scene_bvh_rebuild || m_scene_bvh_refits >= REFITS_PER_REBUILD;
+    if (!rebuild && !m_scene_bvh_stale)
+        return;
+
+    // Items keep their object until the next build. A removed one gets an empty box, which the
+    // slab test always rejects and which the refit's union ignores.
+    if (!rebuild)
     {
-        float t1 = (bbox.min[d] - ray.origin[d]) * ray.direction_inv[d];
-        float t2 = (bbox.max[d] - ray.origin[d]) * ray.direction_inv[d];
+        size_t removed = 0;
+        for (size_t item = 0; item < m_scene_bvh_handles.size(); item++)
+        {
+            if (const std::shared_ptr<GameObject>* entry = m_objects.get(m_scene_bvh_handles[item]))
+            {
+                m_scene_bounds[item] = (*entry)->getBoundingBox();
+                continue;
+            }
 
-        tmin = std::min(std::max(t1, tmin), std::max(t2, tmin));
-        tmax = std::max(std::min(t1, tmax), std::min(t2, tmax));
+            m_scene_bounds[item] = { glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()) };
+            removed++;
+        }
 
+        // Mostly dead items are not worth walking any more
+        rebuild = removed * 2 > m_scene_bvh_handles.size();
     }
 
-    out_t = (tmin <= tmax) ? tmin : -1.0f;
+    // Refitting keeps the tree shape, which gets looser the further objects move
+    if (rebuild)
+    {
+        m_scene_bounds.resize(m_objects.size());
+        m_scene_bvh_handles.resize(m_objects.size());
+        for (size_t i = 0; i < m_objects.size(); i++)
+        {
+            m_scene_bounds[i] = m_objects[i]->getBoundingBox();
+            m_scene_bvh_handles[i] = m_objects.getHandle(i);
+        }
 
-    return tmin <= tmax;
+        m_scene_bvh.build(m_scene_bounds);
+        m_scene_bvh_refits = 0;
+        m_scene_bvh_rebuild = false;
+    }
+    else
+    {
+        m_scene_bvh.refit(m_scene_bounds);
+        m_scene_bvh_refits++;
+    }
+    m_scene_bvh_stale = false;
 }
 
 /// <summary>
@@ -230,32 +725,10 @@ bool Xplor::EngineManager::rayIntersectsAABB(const Xplor::Ray & ray, const Bound
 /// <param name="position"></param>
 void Xplor::EngineManager::addDebugObject(const glm::vec3& position)
 {
-    std::shared_ptr<Xplor::PropObject> debug_object = std::make_shared<Xplor::PropObject>();
-    debug_object->setName("Debug Object");
-    debug_object->setPosition(position);
-
-    debug_object->addTexture("images//debug.jpg", ImageFormat::jpg);
-    debug_object->initTextures();
-
-    // Add a simple shader
-    auto shader = std::make_shared<Shader>("..//resources//shaders//simple.vs", "..//resources//shaders//simple.fs");
-    shader->init();
-    debug_object->addShader(shader);
-    auto shader_id = debug_object->getShader();
-
-    shader_id->useProgram();
-    shader_id->setUniform("customTexture1", 0);
-    shader_id->endProgram();
-
-    auto cube_data = GeometryGenerator::GenerateCubeData();
-    const int step_size = 5;
-    const int index_count = 36;
-    debug_object->addGeometry(cube_data.data(), cube_data.size(), step_size, index_count);
-    debug_object->initGeometry();
-
-
-    addGameObject(debug_object);
+    if (!m_debug_simple_prefab)
+        m_debug_simple_prefab = createDebugPrefab(true);
 
+    spawn(*m_debug_simple_prefab, position);
 }
 
 /// <summary>
@@ -265,28 +738,67 @@ void Xplor::EngineManager::addDebugObject(const glm::vec3& position)
 /// <param name="velocity"></param>
 void Xplor::EngineManager::addDebugObject(const glm::vec3& position, const glm::vec3& velocity)
 {
-    std::shared_ptr<Xplor::PropObject> debug_object = std::make_shared<Xplor::PropObject>();
-    debug_object->setName("Debug Object");
-    debug_object->setPosition(position);
+    if (!m_debug_prefab)
+        m_debug_prefab = createDebugPrefab(false, DEBUG_PROJECTILE_LIFETIME);
 
-    // Should have a way to check if the current texture already exists
-    // this should exist somewhere else for better performance
-    debug_object->addTexture("images//debug.jpg", ImageFormat::jpg);
-    debug_object->initTextures();
+    spawn(*m_debug_prefab, position, velocity);
+}
 
-    // Use a the one texture shader
-    auto shader_manager = ShaderManager::getInstance();
-    std::shared_ptr<Shader> shader;
-    shader_manager->findShader("one texture", shader);
-    debug_object->addShader(shader);
+Xplor::Handle Xplor::EngineManager::spawn(const Prefab& prefab, const glm::vec3& position, const glm::vec3& velocity)
+{
+    std::shared_ptr<GameObject> object;
+    auto pool = m_object_pools.find(prefab.getSource().get());
+    if (pool != m_object_pools.end() && !pool->second.empty())
+    {
+        object = std::move(pool->second.back());
+        pool->second.pop_back();
+        m_pooled_object_count--;
+        object->initFromPrefab(prefab.getSource());
+    }
+    else
+    {
+        object = prefab.instantiate();
+    }
+
+    object->setPosition(position);
+    if (velocity != glm::vec3(0.0f))
+        object->setVelocity(velocity);
+    return addGameObject(std::move(object));
+}
 
-    auto cube_data = GeometryGenerator::GenerateCubeData();
-    const int step_size = 5;
-    const int index_count = 36;
-    debug_object->addGeometry(cube_data.data(), cube_data.size(), step_size, index_count);
-    debug_object->initGeometry();
+/// <summary>
+/// Build the debug cube once, every debug object afterwards is an instance of it
+/// </summary>
+std::unique_ptr<Xplor::Prefab> Xplor::EngineManager::createDebugPrefab(bool simple_shader, float time_to_live)
+{
+    std::shared_ptr<Xplor::PropObject> debug_object = Xplor::MakePooled<Xplor::PropObject>();
+    debug_object->setName("Debug Object");
+    debug_object->setTimeToLive(time_to_live);
+    debug_object->setDespawnOutsideWorld(true);
+
+    // Texture, shader and buffer creation need the OpenGL context
+    runOnRenderThread([&]() {
+        debug_object->addTexture("images//debug.jpg", ImageFormat::jpg);
+        debug_object->initTextures();
+
+        std::shared_ptr<Shader> shader;
+        if (simple_shader)
+        {
+            shader = std::make_shared<Shader>("..//resources//shaders//simple.vs", "..//resources//shaders//simple.fs");
+            shader->init();
+        }
+        else
+        {
+            ShaderManager::getInstance()->findShader("one texture"_sid, shader);
+        }
+        debug_object->addShader(shader);
 
-    debug_object->setVelocity(velocity);
-    addGameObject(debug_object);
+        auto cube_data = GeometryGenerator::GenerateCubeData();
+        const int step_size = 5;
+        const int index_count = 36;
+        debug_object->addGeometry(cube_data.data(), cube_data.size(), step_size, index_count);
+        debug_object->initGeometry();
+    });
 
+    return std::make_unique<Prefab>(debug_object);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace Xplor
+{
+	namespace
+	{
+		constexpr size_t BLOCK_ALIGNMENT = alignof(std::max_align_t);
+	}
+
+	FrameArena::FrameArena(size_t capacity)
+		: m_capacity(capacity)
+	{
+		m_block = static_cast<std::byte*>(::operator new(m_capacity, std::align_val_t(BLOCK_ALIGNMENT)));
+	}
+
+	FrameArena::~FrameArena()
+	{
+		reset();
+		::operator delete(m_block, std::align_val_t(BLOCK_ALIGNMENT));
+	}
+
+	void FrameArena::reset()
+	{
+		m_peak = std::max(m_peak, getUsed());
+
+		for (const Overflow& overflow : m_overflow)
+		{
+			::operator delete(overflow.data, std::align_val_t(overflow.alignment));
+		}
+
+		// Grow to the peak with some headroom, a frame that overflowed once will not again
+		if (!m_overflow.empty())
+		{
+			::operator delete(m_block, std::align_val_t(BLOCK_ALIGNMENT));
+			m_capacity = m_peak + m_peak / 2;
+			m_block = static_cast<std::byte*>(::operator new(m_capacity, std::align_val_t(BLOCK_ALIGNMENT)));
+		}
+
+		m_overflow.clear();
+		m_overflow_bytes = 0;
+		m_used = 0;
+	}
+
+	void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		const uintptr_t base = reinterpret_cast<uintptr_t>(m_block);
+		const uintptr_t aligned = (base + m_used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		const size_t end = static_cast<size_t>(aligned - base) + bytes;
+		if (end <= m_capacity)
+		{
+			m_used = end;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		// Out of space, serve this frame from the heap and grow on the next reset
+		alignment = std::max(alignment, alignof(std::max_align_t));
+		void* data = ::operator new(bytes, std::align_val_t(alignment));
+		m_overflow.push_back({ data, bytes, alignment });
+		m_overflow_bytes += bytes;
+		return data;
+	}
+}
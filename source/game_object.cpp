@@ -43,118 +43,67 @@ namespace Xplor
 
 		glBindVertexArray(0); // Unbind the VAO
 
-		initBoundingBoxDraw();
-	}
-
-	void GameObject::initBoundingBoxDraw()
-	{
-		if (m_bboxVAO == 0)
-		{
-			// Get bounding box vertices and indices
-			updateBoundingBox();
-			auto vertices = GeometryGenerator::GenerateBoundingBoxVertices(m_bbox.min, m_bbox.max);
+		m_index_count = m_geometry.GetEBO() ? m_geometry.GetEBOSize() : m_geometry.GetIndexCount();
 
-			// Generate relevant buffers
-			glGenVertexArrays(1, &m_bboxVAO);
-			glGenBuffers(1, &m_bboxVBO);
+		m_mesh = MeshManager::getInstance()->getMesh(m_geometry);
+		m_local_bounds = m_mesh->getLocalBounds();
+		m_local_sphere = m_mesh->getLocalSphere();
 
-			glBindVertexArray(m_bboxVAO); // Bind the VAO
-
-			// Bind VBO and fill the buffer
-			glBindBuffer(GL_ARRAY_BUFFER, m_bboxVBO);
-			glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-			// Vertex Positions
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), reinterpret_cast<GLvoid*>(0));
-			glEnableVertexAttribArray(0); // enable layout 0
-
-			glBindVertexArray(0); // unbind VAO
-		}
+		updateBoundingBox();
 	}
 
-	void GameObject::draw(glm::mat4 view_matrix, glm::mat4 projection_matrix)
+	void GameObject::initFromPrefab(const std::shared_ptr<const GameObject>& source)
 	{
-		m_shader->useProgram();
-
-		// Send coordinate matrices to the shader
-		updateModelMatrix();
-		m_shader->setUniform("model", m_model_matrix);
-		m_shader->setUniform("view", view_matrix);
-		m_shader->setUniform("projection", projection_matrix);
-
-		// Bind Relevant Textures
-		for (int i = 0; i < m_textures.size(); i++)
-		{
-			glActiveTexture(GL_TEXTURE0 + i);
-			glBindTexture(GL_TEXTURE_2D, m_textures[i]);
-		}
+		m_prefab_source = source;
+		m_object_type = source->m_object_type;
+		m_name = source->m_name;
+		m_material = source->m_material;
+		m_VAO = source->m_VAO;
+		m_EBO = source->m_EBO;
+		m_index_count = source->m_index_count;
+		m_mesh = source->m_mesh;
+		m_local_bounds = source->m_local_bounds;
+		m_local_sphere = source->m_local_sphere;
+
+		m_scale = source->m_scale;
+		m_rotation_axis = source->m_rotation_axis;
+		m_rotation_amount = source->m_rotation_amount;
+		m_rotation_scale = source->m_rotation_scale;
+		m_velocity = source->m_velocity;
+		m_acceleration = source->m_acceleration;
+		m_damping = source->m_damping;
+		m_time_to_live = source->m_time_to_live;
+		m_despawn_outside_world = source->m_despawn_outside_world;
+
+		updateBoundingBox();
+	}
 
+	bool GameObject::getDrawItem(DrawItem& out_item, float alpha)
+	{
+		if (!m_material || !m_VAO)
+			return false;
 
-		glBindVertexArray(m_VAO);
+		out_item.sort_key = getSortKey();
+		out_item.material = m_material.get();
+		out_item.VAO = m_VAO;
 		// Check for an EBO
-		if (!m_EBO)
-		{
-			// change this to draw to a variable size
-			glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_geometry.GetIndexCount()));
-		}
-		else
-		{
-			glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(m_geometry.GetEBOSize()), GL_UNSIGNED_INT, 0);
-		}
-
-		// Unbinds
-		glBindVertexArray(0); // Unbind the VAO
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-		m_shader->endProgram();
+		out_item.indexed = m_EBO != 0;
+		out_item.element_count = static_cast<uint32_t>(m_index_count);
+		out_item.uniforms = getObjectUniforms(alpha);
+		return true;
 	}
 
-	void GameObject::drawBoundingBox(const glm::mat4& view_matrix, const glm::mat4& projection_matrix)
+	std::shared_ptr<GameObject> CreateGameObject(GameObjectType type)
 	{
-		// Set the shader
-		std::shared_ptr<Shader> bbox_shader;
-		ShaderManager::getInstance()->findShader("bounding", bbox_shader);
-		bbox_shader->useProgram();
-
-		// Set the view and projection matrices
-		bbox_shader->setUniform("view", view_matrix);
-		bbox_shader->setUniform("projection", projection_matrix);
-
-
-		// No need to translate as the bounding box already takes the objects position into account
-		glm::mat4 model = glm::mat4(1.0f);
-		//model = glm::translate(model, m_position);
-		// Scale too?
-		/*if (m_rotation_amount)
+		switch (type)
 		{
-			model = glm::rotate(model, glm::radians(m_rotation_amount), m_rotation_axis);
-		}*/
-
-		// If the model moves update the geometry of the box to follow precisely
-		if (m_last_position != m_position)
-		{
-			m_last_position = m_position;
-			updateBoundingBox();
-			auto vertices = GeometryGenerator::GenerateBoundingBoxVertices(m_bbox.min, m_bbox.max);
-			glBindBuffer(GL_ARRAY_BUFFER, m_bboxVBO);
-			glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+		case GameObjectType::PropObject:
+			return MakePooled<PropObject>();
+		case GameObjectType::GameObject:
+			return MakePooled<GameObject>();
+		default:
+			assert(false && "Undefined enum value in switch statement");
+			return MakePooled<GameObject>();
 		}
-
-		
-		bbox_shader->setUniform("model", model);
-
-
-
-		// Draw the bounding box
-		glBindVertexArray(m_bboxVAO);
-		GLsizei bounding_vertex_count = 36;
-		//glDrawElements(GL_LINES, bounding_index_count, GL_UNSIGNED_INT, 0);
-		glLineWidth(10.0f);
-		glDrawArrays(GL_LINE_STRIP, 0, static_cast<GLsizei>(bounding_vertex_count));
-		
-
-		glBindVertexArray(0); // unbind VAO
-		bbox_shader->endProgram();
-		glLineWidth(1.0f); // restore line width
 	}
-}
-
+}
\ No newline at end of file
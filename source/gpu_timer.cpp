@@ -0,0 +1,153 @@
+#include "gpu_timer.hpp"
+#include "profiler.hpp"
+
+namespace Xplor
+{
+	void GpuTimer::init()
+	{
+		for (FrameQueries& frame : m_frames)
+		{
+			glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+		}
+		m_initialized = true;
+	}
+
+	void GpuTimer::destroy()
+	{
+		if (!m_initialized)
+			return;
+
+		for (FrameQueries& frame : m_frames)
+		{
+			glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+			frame = {};
+		}
+		m_initialized = false;
+	}
+
+	void GpuTimer::beginFrame()
+	{
+		if (!m_initialized)
+			return;
+
+		FrameQueries& frame = m_frames[m_frame % FRAMES_IN_FLIGHT];
+		if (frame.pending)
+		{
+			// Timestamps complete in order, the last one being ready means all of them are
+			GLint available = 0;
+			glGetQueryObjectiv(frame.last_query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				readResults(frame);
+			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(m_history_mutex);
+				m_skipped_frames++;
+			}
+		}
+
+		frame.issued.fill(false);
+		frame.pending = false;
+
+		// Maps this frame's timestamps onto the profiler clock for the trace. Reading the GPU
+		// clock does not wait for queued commands to execute.
+		GLint64 gpu_now = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+		frame.cpu_offset = static_cast<int64_t>(Profiler::now()) - gpu_now;
+	}
+
+	void GpuTimer::beginPass(GpuPass pass)
+	{
+		if (!m_initialized)
+			return;
+
+		FrameQueries& frame = m_frames[m_frame % FRAMES_IN_FLIGHT];
+		glQueryCounter(frame.queries[static_cast<uint32_t>(pass) * 2], GL_TIMESTAMP);
+	}
+
+	void GpuTimer::endPass(GpuPass pass)
+	{
+		if (!m_initialized)
+			return;
+
+		FrameQueries& frame = m_frames[m_frame % FRAMES_IN_FLIGHT];
+		const GLuint query = frame.queries[static_cast<uint32_t>(pass) * 2 + 1];
+		glQueryCounter(query, GL_TIMESTAMP);
+		frame.issued[static_cast<uint32_t>(pass)] = true;
+		frame.last_query = query;
+		frame.pending = true;
+	}
+
+	void GpuTimer::endFrame()
+	{
+		m_frame++;
+	}
+
+	void GpuTimer::readResults(FrameQueries& frame)
+	{
+		std::array<float, PASS_COUNT> pass_ms{};
+		for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+		{
+			if (!frame.issued[pass])
+				continue;
+
+			GLuint64 start = 0;
+			GLuint64 end = 0;
+			glGetQueryObjectui64v(frame.queries[pass * 2], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(frame.queries[pass * 2 + 1], GL_QUERY_RESULT, &end);
+			pass_ms[pass] = static_cast<float>(end - start) / 1000000.0f;
+
+			if (Profiler::isCapturing())
+			{
+				Profiler::recordGpu(GetPassName(static_cast<GpuPass>(pass)),
+					static_cast<uint64_t>(static_cast<int64_t>(start) + frame.cpu_offset),
+					static_cast<uint64_t>(static_cast<int64_t>(end) + frame.cpu_offset));
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_history_mutex);
+		float frame_ms = 0.0f;
+		for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+		{
+			m_history[pass][m_history_head] = pass_ms[pass];
+			frame_ms += pass_ms[pass];
+		}
+		m_history_head = (m_history_head + 1) % HISTORY_SIZE;
+		m_latest_frame_ms = frame_ms;
+	}
+
+	void GpuTimer::getHistory(GpuPass pass, History& out_history, uint32_t& out_offset) const
+	{
+		std::lock_guard<std::mutex> lock(m_history_mutex);
+		out_history = m_history[static_cast<uint32_t>(pass)];
+		out_offset = m_history_head;
+	}
+
+	float GpuTimer::getLatestFrameMs() const
+	{
+		std::lock_guard<std::mutex> lock(m_history_mutex);
+		return m_latest_frame_ms;
+	}
+
+	uint64_t GpuTimer::getSkippedFrameCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_history_mutex);
+		return m_skipped_frames;
+	}
+
+	const char* GpuTimer::GetPassName(GpuPass pass)
+	{
+		switch (pass)
+		{
+		case GpuPass::Scene:
+			return "Scene";
+		case GpuPass::BoundingBoxes:
+			return "Bounding Boxes";
+		case GpuPass::UI:
+			return "UI";
+		default:
+			return "Unknown";
+		}
+	}
+}
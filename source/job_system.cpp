@@ -0,0 +1,166 @@
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace Xplor
+{
+	namespace
+	{
+		thread_local uint32_t t_thread_index = 0;
+		thread_local const void* t_group = nullptr;
+	}
+
+	JobSystem::JobSystem()
+	{
+		// One thread is left for the main thread and one for the render thread
+		uint32_t hardware_threads = std::max(std::thread::hardware_concurrency(), 2u);
+		uint32_t worker_count = std::max(hardware_threads - 2, 1u);
+
+		for (uint32_t i = 0; i < worker_count; i++)
+		{
+			m_workers.emplace_back(&JobSystem::workerMain, this, i + 1);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	uint32_t JobSystem::GetThreadIndex()
+	{
+		return t_thread_index;
+	}
+
+	const void* JobSystem::GetGroup()
+	{
+		return t_group;
+	}
+
+	void JobSystem::SetGroup(const void* group)
+	{
+		t_group = group;
+	}
+
+	void JobSystem::run(std::function<void()> job, JobCounter* counter)
+	{
+		if (counter)
+			counter->remaining.fetch_add(1, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back({ std::move(job), counter, t_group });
+		}
+		m_condition.notify_one();
+	}
+
+	void JobSystem::execute(Job& job)
+	{
+		{
+			XPLOR_PROFILE_SCOPE("Job");
+			JobGroupScope group(job.group);
+			job.function();
+		}
+		if (job.counter)
+			job.counter->remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	bool JobSystem::tryRunOne(const void* group)
+	{
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto iterator = m_queue.begin();
+			if (group)
+				iterator = std::find_if(m_queue.begin(), m_queue.end(), [group](const Job& queued) { return queued.group == group; });
+			if (iterator == m_queue.end())
+				return false;
+			job = std::move(*iterator);
+			m_queue.erase(iterator);
+		}
+
+		execute(job);
+		return true;
+	}
+
+	void JobSystem::wait(const JobCounter& counter)
+	{
+		while (!counter.isDone())
+		{
+			// Help with the queue, the jobs we wait for may be sitting in it
+			if (!tryRunOne(nullptr))
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::parallelForRanges(size_t count, size_t min_batch, RangeFunction function, void* context)
+	{
+		if (count == 0)
+			return;
+
+		min_batch = std::max<size_t>(min_batch, 1);
+		size_t batch_count = std::min<size_t>({ getThreadCount(), (count + min_batch - 1) / min_batch, MAX_PARALLEL_BATCHES });
+
+		// Not worth a trip through the queue
+		if (batch_count <= 1)
+		{
+			function(context, 0, count, GetThreadIndex());
+			return;
+		}
+
+		// Jobs only capture a pointer to their batch, small enough for std::function to store inline
+		struct Batch {
+			RangeFunction function;
+			void* context;
+			size_t begin;
+			size_t end;
+		};
+		std::array<Batch, MAX_PARALLEL_BATCHES> batches;
+
+		size_t batch_size = (count + batch_count - 1) / batch_count;
+		JobCounter counter;
+		size_t batch_index = 0;
+		for (size_t begin = batch_size; begin < count; begin += batch_size)
+		{
+			Batch* batch = &batches[batch_index++];
+			*batch = { function, context, begin, std::min(begin + batch_size, count) };
+			run([batch]() { batch->function(batch->context, batch->begin, batch->end, GetThreadIndex()); }, &counter);
+		}
+
+		// The first batch runs on the calling thread
+		function(context, 0, std::min(batch_size, count), GetThreadIndex());
+		wait(counter);
+	}
+
+	void JobSystem::workerMain(uint32_t thread_index)
+	{
+		t_thread_index = thread_index;
+		XPLOR_PROFILE_THREAD("Worker " + std::to_string(thread_index));
+
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_condition.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+				if (m_stop && m_queue.empty())
+					return;
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+
+			execute(job);
+		}
+	}
+}
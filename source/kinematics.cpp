@@ -0,0 +1,191 @@
+#include "kinematics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if XPLOR_SIMD_X86
+#include <xmmintrin.h>
+#endif
+
+namespace Xplor
+{
+	namespace
+	{
+		void IntegrateWith(SimdLevel level, KinematicsBatch& batch, float delta_time, size_t begin, size_t end)
+		{
+			switch (level)
+			{
+#if XPLOR_SIMD_X86
+			case SimdLevel::AVX:
+				Detail::IntegrateKinematicsAVX(batch.getStreams(), delta_time, begin, end);
+				break;
+			case SimdLevel::SSE:
+				Detail::IntegrateKinematicsSSE(batch.getStreams(), delta_time, begin, end);
+				break;
+#endif
+			default:
+				Detail::IntegrateKinematicsScalar(batch.getStreams(), delta_time, begin, end);
+			}
+		}
+
+#if XPLOR_SIMD_X86
+		inline void IntegrateAxisSSE(float* position, float* velocity, const float* acceleration, const float* half_extent,
+			float* bounds_min, float* bounds_max, __m128 factor, __m128 dt)
+		{
+			__m128 v = _mm_loadu_ps(velocity);
+			v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(acceleration), dt));
+			v = _mm_mul_ps(v, factor);
+			__m128 p = _mm_add_ps(_mm_loadu_ps(position), _mm_mul_ps(v, dt));
+			__m128 h = _mm_loadu_ps(half_extent);
+
+			_mm_storeu_ps(velocity, v);
+			_mm_storeu_ps(position, p);
+			_mm_storeu_ps(bounds_min, _mm_sub_ps(p, h));
+			_mm_storeu_ps(bounds_max, _mm_add_ps(p, h));
+		}
+#endif
+	}
+
+	void KinematicsBatch::resize(size_t count)
+	{
+		for (auto* component : { &position_x, &position_y, &position_z,
+			&velocity_x, &velocity_y, &velocity_z,
+			&acceleration_x, &acceleration_y, &acceleration_z,
+			&damping,
+			&half_extent_x, &half_extent_y, &half_extent_z,
+			&bounds_min_x, &bounds_min_y, &bounds_min_z,
+			&bounds_max_x, &bounds_max_y, &bounds_max_z })
+		{
+			component->resize(count);
+		}
+	}
+
+	KinematicsStreams KinematicsBatch::getStreams()
+	{
+		return {
+			position_x.data(), position_y.data(), position_z.data(),
+			velocity_x.data(), velocity_y.data(), velocity_z.data(),
+			acceleration_x.data(), acceleration_y.data(), acceleration_z.data(),
+			damping.data(),
+			half_extent_x.data(), half_extent_y.data(), half_extent_z.data(),
+			bounds_min_x.data(), bounds_min_y.data(), bounds_min_z.data(),
+			bounds_max_x.data(), bounds_max_y.data(), bounds_max_z.data()
+		};
+	}
+
+	void IntegrateKinematics(KinematicsBatch& batch, float delta_time, size_t begin, size_t end)
+	{
+		IntegrateWith(GetSimdLevel(), batch, delta_time, begin, end);
+	}
+
+	std::vector<KinematicsBenchmarkResult> BenchmarkKinematics(size_t count, uint32_t iterations)
+	{
+		// Fixed seed so every kernel integrates the same scene
+		KinematicsBatch source;
+		source.resize(count);
+		std::mt19937 generator(1234);
+		std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> velocity(-5.0f, 5.0f);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		for (size_t i = 0; i < count; i++)
+		{
+			source.position_x[i] = position(generator);
+			source.position_y[i] = position(generator);
+			source.position_z[i] = position(generator);
+			source.velocity_x[i] = velocity(generator);
+			source.velocity_y[i] = velocity(generator);
+			source.velocity_z[i] = velocity(generator);
+			source.acceleration_x[i] = 0.0f;
+			source.acceleration_y[i] = -9.81f * unit(generator);
+			source.acceleration_z[i] = 0.0f;
+			source.damping[i] = 0.1f * unit(generator);
+			source.half_extent_x[i] = source.half_extent_y[i] = source.half_extent_z[i] = 0.5f;
+		}
+
+		const float delta_time = 1.0f / 60.0f;
+		std::vector<KinematicsBenchmarkResult> results;
+		KinematicsBatch reference;
+
+		for (SimdLevel level = SimdLevel::Scalar; level <= GetSupportedSimdLevel(); level = static_cast<SimdLevel>(static_cast<int>(level) + 1))
+		{
+			KinematicsBatch batch = source;
+
+			auto start = std::chrono::steady_clock::now();
+			for (uint32_t iteration = 0; iteration < iterations; iteration++)
+			{
+				IntegrateWith(level, batch, delta_time, 0, count);
+			}
+			auto end = std::chrono::steady_clock::now();
+			float ms = std::chrono::duration<float, std::milli>(end - start).count();
+
+			if (level == SimdLevel::Scalar)
+				reference = batch;
+
+			float max_error = 0.0f;
+			for (size_t i = 0; i < count; i++)
+			{
+				max_error = std::max(max_error, std::abs(batch.position_x[i] - reference.position_x[i]));
+				max_error = std::max(max_error, std::abs(batch.position_y[i] - reference.position_y[i]));
+				max_error = std::max(max_error, std::abs(batch.position_z[i] - reference.position_z[i]));
+			}
+
+			float objects = static_cast<float>(count) * static_cast<float>(iterations);
+			results.push_back({ level, ms > 0.0f ? objects / ms : 0.0f, max_error });
+		}
+
+		return results;
+	}
+
+	namespace Detail
+	{
+		void IntegrateKinematicsScalar(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const float factor = std::max(0.0f, 1.0f - streams.damping[i] * delta_time);
+
+				streams.velocity_x[i] = (streams.velocity_x[i] + streams.acceleration_x[i] * delta_time) * factor;
+				streams.velocity_y[i] = (streams.velocity_y[i] + streams.acceleration_y[i] * delta_time) * factor;
+				streams.velocity_z[i] = (streams.velocity_z[i] + streams.acceleration_z[i] * delta_time) * factor;
+
+				streams.position_x[i] += streams.velocity_x[i] * delta_time;
+				streams.position_y[i] += streams.velocity_y[i] * delta_time;
+				streams.position_z[i] += streams.velocity_z[i] * delta_time;
+
+				streams.bounds_min_x[i] = streams.position_x[i] - streams.half_extent_x[i];
+				streams.bounds_min_y[i] = streams.position_y[i] - streams.half_extent_y[i];
+				streams.bounds_min_z[i] = streams.position_z[i] - streams.half_extent_z[i];
+				streams.bounds_max_x[i] = streams.position_x[i] + streams.half_extent_x[i];
+				streams.bounds_max_y[i] = streams.position_y[i] + streams.half_extent_y[i];
+				streams.bounds_max_z[i] = streams.position_z[i] + streams.half_extent_z[i];
+			}
+		}
+
+#if XPLOR_SIMD_X86
+		void IntegrateKinematicsSSE(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end)
+		{
+			const __m128 dt = _mm_set1_ps(delta_time);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 zero = _mm_setzero_ps();
+
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4)
+			{
+				__m128 factor = _mm_max_ps(zero, _mm_sub_ps(one, _mm_mul_ps(_mm_loadu_ps(&streams.damping[i]), dt)));
+
+				IntegrateAxisSSE(&streams.position_x[i], &streams.velocity_x[i], &streams.acceleration_x[i], &streams.half_extent_x[i],
+					&streams.bounds_min_x[i], &streams.bounds_max_x[i], factor, dt);
+				IntegrateAxisSSE(&streams.position_y[i], &streams.velocity_y[i], &streams.acceleration_y[i], &streams.half_extent_y[i],
+					&streams.bounds_min_y[i], &streams.bounds_max_y[i], factor, dt);
+				IntegrateAxisSSE(&streams.position_z[i], &streams.velocity_z[i], &streams.acceleration_z[i], &streams.half_extent_z[i],
+					&streams.bounds_min_z[i], &streams.bounds_max_z[i], factor, dt);
+			}
+
+			// Remainder that does not fill a register
+			IntegrateKinematicsScalar(streams, delta_time, i, end);
+		}
+#endif
+	}
+}
@@ -0,0 +1,53 @@
+#include "kinematics.hpp"
+
+// Built with AVX code generation, nothing in here may run before GetSupportedSimdLevel reports AVX
+#if XPLOR_SIMD_X86
+#include <immintrin.h>
+
+namespace Xplor
+{
+	namespace
+	{
+		inline void IntegrateAxisAVX(float* position, float* velocity, const float* acceleration, const float* half_extent,
+			float* bounds_min, float* bounds_max, __m256 factor, __m256 dt)
+		{
+			__m256 v = _mm256_loadu_ps(velocity);
+			v = _mm256_add_ps(v, _mm256_mul_ps(_mm256_loadu_ps(acceleration), dt));
+			v = _mm256_mul_ps(v, factor);
+			__m256 p = _mm256_add_ps(_mm256_loadu_ps(position), _mm256_mul_ps(v, dt));
+			__m256 h = _mm256_loadu_ps(half_extent);
+
+			_mm256_storeu_ps(velocity, v);
+			_mm256_storeu_ps(position, p);
+			_mm256_storeu_ps(bounds_min, _mm256_sub_ps(p, h));
+			_mm256_storeu_ps(bounds_max, _mm256_add_ps(p, h));
+		}
+	}
+
+	namespace Detail
+	{
+		void IntegrateKinematicsAVX(const KinematicsStreams& streams, float delta_time, size_t begin, size_t end)
+		{
+			const __m256 dt = _mm256_set1_ps(delta_time);
+			const __m256 one = _mm256_set1_ps(1.0f);
+			const __m256 zero = _mm256_setzero_ps();
+
+			size_t i = begin;
+			for (; i + 8 <= end; i += 8)
+			{
+				__m256 factor = _mm256_max_ps(zero, _mm256_sub_ps(one, _mm256_mul_ps(_mm256_loadu_ps(&streams.damping[i]), dt)));
+
+				IntegrateAxisAVX(&streams.position_x[i], &streams.velocity_x[i], &streams.acceleration_x[i], &streams.half_extent_x[i],
+					&streams.bounds_min_x[i], &streams.bounds_max_x[i], factor, dt);
+				IntegrateAxisAVX(&streams.position_y[i], &streams.velocity_y[i], &streams.acceleration_y[i], &streams.half_extent_y[i],
+					&streams.bounds_min_y[i], &streams.bounds_max_y[i], factor, dt);
+				IntegrateAxisAVX(&streams.position_z[i], &streams.velocity_z[i], &streams.acceleration_z[i], &streams.half_extent_z[i],
+					&streams.bounds_min_z[i], &streams.bounds_max_z[i], factor, dt);
+			}
+
+			// Leftover objects go through the SSE kernel, which handles its own scalar remainder
+			IntegrateKinematicsSSE(streams, delta_time, i, end);
+		}
+	}
+}
+#endif
@@ -0,0 +1,220 @@
+#include "log.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace Xplor
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::chrono::milliseconds FLUSH_INTERVAL(5);
+
+		constexpr const char* LEVEL_NAMES[] = { "Trace", "Debug", "Info", "Warning", "Error" };
+		constexpr const char* CATEGORY_NAMES[] = { "Core", "Render", "Shader", "Scene", "Physics", "Input" };
+		static_assert(sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0]) == static_cast<size_t>(LogCategory::Count), "Every category needs a name");
+		static_assert((Log::RING_SIZE & (Log::RING_SIZE - 1)) == 0, "The ring size has to be a power of two");
+
+		// Bounded multi producer queue: a slot is free for the writer whose position matches its
+		// sequence, and readable once the writer bumped the sequence past that position
+		struct Slot {
+			std::atomic<uint64_t> sequence;
+			double time;
+			LogLevel level;
+			LogCategory category;
+			char text[Log::MESSAGE_SIZE];
+		};
+
+		struct LogState {
+			std::array<Slot, Log::RING_SIZE> slots;
+			alignas(64) std::atomic<uint64_t> enqueue{};
+			alignas(64) uint64_t dequeue{};
+			std::atomic<uint64_t> dropped{};
+			uint64_t dropped_reported{};
+			std::atomic<uint8_t> level{ static_cast<uint8_t>(LogLevel::Trace) };
+			std::atomic<uint32_t> categories{ ~0u };
+			std::atomic<bool> running{};
+			std::atomic<bool> stopped{};
+			std::once_flag started;
+			std::mutex drain_mutex; // flush() may drain while the thread does
+			std::thread thread;
+			Clock::time_point start{ Clock::now() };
+
+			LogState()
+			{
+				for (uint32_t i = 0; i < Log::RING_SIZE; i++)
+				{
+					slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+		};
+
+		// Never destroyed, so messages from static destructors still have somewhere to go
+		LogState& GetState()
+		{
+			static LogState* state = new LogState();
+			return *state;
+		}
+
+		void Print(double time, LogLevel level, LogCategory category, const char* text)
+		{
+			std::fprintf(level == LogLevel::Error ? stderr : stdout, "[%9.3f] [%s] [%s] %s\n", time,
+				LEVEL_NAMES[static_cast<size_t>(level)], CATEGORY_NAMES[static_cast<size_t>(category)], text);
+		}
+
+		void Drain(LogState& state)
+		{
+			std::lock_guard<std::mutex> lock(state.drain_mutex);
+
+			bool wrote = false;
+			for (;;)
+			{
+				Slot& slot = state.slots[state.dequeue & (Log::RING_SIZE - 1)];
+				if (slot.sequence.load(std::memory_order_acquire) != state.dequeue + 1)
+					break;
+
+				Print(slot.time, slot.level, slot.category, slot.text);
+				slot.sequence.store(state.dequeue + Log::RING_SIZE, std::memory_order_release);
+				state.dequeue++;
+				wrote = true;
+			}
+
+			const uint64_t dropped = state.dropped.load(std::memory_order_relaxed);
+			if (dropped != state.dropped_reported)
+			{
+				std::fprintf(stderr, "[Log] %llu messages dropped, the ring buffer was full\n",
+					static_cast<unsigned long long>(dropped - state.dropped_reported));
+				state.dropped_reported = dropped;
+				wrote = true;
+			}
+
+			if (wrote)
+			{
+				std::fflush(stdout);
+				std::fflush(stderr);
+			}
+		}
+
+		void Run(LogState& state)
+		{
+			while (state.running.load(std::memory_order_acquire))
+			{
+				Drain(state);
+				std::this_thread::sleep_for(FLUSH_INTERVAL);
+			}
+		}
+
+		// Stops the flush thread during static destruction, after this messages are written directly
+		struct FlushThreadGuard {
+			~FlushThreadGuard()
+			{
+				LogState& state = GetState();
+				state.running.store(false, std::memory_order_release);
+				if (state.thread.joinable())
+					state.thread.join();
+				Drain(state);
+				state.stopped.store(true, std::memory_order_release);
+			}
+		};
+
+		void StartFlushThread(LogState& state)
+		{
+			static FlushThreadGuard guard;
+			state.running.store(true, std::memory_order_release);
+			state.thread = std::thread(Run, std::ref(state));
+		}
+	}
+
+	void Log::write(LogLevel level, LogCategory category, const char* format, ...)
+	{
+		LogState& state = GetState();
+		if (static_cast<uint8_t>(level) < state.level.load(std::memory_order_relaxed) ||
+			!(state.categories.load(std::memory_order_relaxed) & (1u << static_cast<uint32_t>(category))))
+			return;
+
+		const double time = std::chrono::duration<double>(Clock::now() - state.start).count();
+
+		va_list arguments;
+		va_start(arguments, format);
+
+		if (state.stopped.load(std::memory_order_acquire))
+		{
+			char text[MESSAGE_SIZE];
+			std::vsnprintf(text, sizeof(text), format, arguments);
+			va_end(arguments);
+			Print(time, level, category, text);
+			return;
+		}
+
+		std::call_once(state.started, StartFlushThread, std::ref(state));
+
+		// Claim a slot, or drop the message when the flush thread is a whole ring behind
+		uint64_t position = state.enqueue.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &state.slots[position & (RING_SIZE - 1)];
+			const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+			const int64_t difference = static_cast<int64_t>(sequence - position);
+			if (difference == 0)
+			{
+				if (state.enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (difference < 0)
+			{
+				va_end(arguments);
+				state.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			else
+			{
+				position = state.enqueue.load(std::memory_order_relaxed);
+			}
+		}
+
+		slot->time = time;
+		slot->level = level;
+		slot->category = category;
+		std::vsnprintf(slot->text, MESSAGE_SIZE, format, arguments);
+		va_end(arguments);
+		slot->sequence.store(position + 1, std::memory_order_release);
+	}
+
+	void Log::setLevel(LogLevel level)
+	{
+		GetState().level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+	}
+
+	void Log::setCategoryEnabled(LogCategory category, bool enabled)
+	{
+		const uint32_t bit = 1u << static_cast<uint32_t>(category);
+		if (enabled)
+			GetState().categories.fetch_or(bit, std::memory_order_relaxed);
+		else
+			GetState().categories.fetch_and(~bit, std::memory_order_relaxed);
+	}
+
+	void Log::flush()
+	{
+		LogState& state = GetState();
+		if (!state.stopped.load(std::memory_order_acquire))
+			Drain(state);
+	}
+
+	uint64_t Log::getDroppedCount()
+	{
+		return GetState().dropped.load(std::memory_order_relaxed);
+	}
+
+	const char* Log::getCategoryName(LogCategory category)
+	{
+		return CATEGORY_NAMES[static_cast<size_t>(category)];
+	}
+}
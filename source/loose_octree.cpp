@@ -0,0 +1,375 @@
+#include "loose_octree.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Xplor
+{
+	namespace
+	{
+		// Squared distance from a point to a box, 0 inside
+		inline float DistanceSquared(const glm::vec3& point, const glm::vec3& box_min, const glm::vec3& box_max)
+		{
+			float distance = 0.0f;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				const float below = box_min[axis] - point[axis];
+				const float above = point[axis] - box_max[axis];
+				const float outside = std::max(0.0f, std::max(below, above));
+				distance += outside * outside;
+			}
+			return distance;
+		}
+
+		inline glm::vec3 LooseMin(const float* center, float half_size)
+		{
+			return glm::vec3(center[0], center[1], center[2]) - glm::vec3(2.0f * half_size);
+		}
+
+		inline glm::vec3 LooseMax(const float* center, float half_size)
+		{
+			return glm::vec3(center[0], center[1], center[2]) + glm::vec3(2.0f * half_size);
+		}
+
+		inline bool Overlaps(const BoundingBox& a, const glm::vec3& b_min, const glm::vec3& b_max)
+		{
+			return a.min.x <= b_max.x && a.max.x >= b_min.x &&
+				a.min.y <= b_max.y && a.max.y >= b_min.y &&
+				a.min.z <= b_max.z && a.max.z >= b_min.z;
+		}
+	}
+
+	LooseOctree::LooseOctree(const glm::vec3& center, float half_size, uint32_t max_depth)
+		: m_min(center - glm::vec3(half_size)), m_size(2.0f * half_size), m_max_depth(std::min(max_depth, MAX_DEPTH_LIMIT))
+	{
+		clear();
+	}
+
+	void LooseOctree::clear()
+	{
+		m_nodes.clear();
+		m_free_nodes.clear();
+		m_node_lookup.clear();
+		m_proxies.clear();
+		m_free_proxies.clear();
+
+		Node root{};
+		const glm::vec3 center = m_min + glm::vec3(m_size * 0.5f);
+		root.center[0] = center.x;
+		root.center[1] = center.y;
+		root.center[2] = center.z;
+		root.half_size = m_size * 0.5f;
+		std::fill(std::begin(root.children), std::end(root.children), NONE);
+		root.parent = NONE;
+		root.first_proxy = NONE;
+		root.key = NodeKey(0, 0, 0, 0);
+		m_nodes.push_back(root);
+		m_node_lookup[root.key] = 0;
+	}
+
+	uint32_t LooseOctree::createProxy(const BoundingBox& bounds, uint32_t user_data)
+	{
+		uint32_t proxy;
+		if (!m_free_proxies.empty())
+		{
+			proxy = m_free_proxies.back();
+			m_free_proxies.pop_back();
+		}
+		else
+		{
+			proxy = static_cast<uint32_t>(m_proxies.size());
+			m_proxies.push_back({});
+		}
+
+		m_proxies[proxy].bounds = bounds;
+		m_proxies[proxy].user_data = user_data;
+		link(proxy, findOrCreateNode(locate(bounds)));
+		return proxy;
+	}
+
+	void LooseOctree::destroyProxy(uint32_t proxy)
+	{
+		assert(proxy < m_proxies.size() && m_proxies[proxy].node != NONE && "Destroying an unknown proxy");
+
+		const uint32_t node = m_proxies[proxy].node;
+		unlink(proxy);
+		prune(node);
+		m_proxies[proxy].node = NONE;
+		m_free_proxies.push_back(proxy);
+	}
+
+	void LooseOctree::updateProxy(uint32_t proxy, const BoundingBox& bounds)
+	{
+		Proxy& entry = m_proxies[proxy];
+		entry.bounds = bounds;
+
+		// Small moves stay within the cell, the loose bounds still cover the box
+		const uint64_t key = locate(bounds);
+		if (m_nodes[entry.node].key == key)
+			return;
+
+		const uint32_t old_node = entry.node;
+		unlink(proxy);
+		link(proxy, findOrCreateNode(key));
+		prune(old_node);
+	}
+
+	uint64_t LooseOctree::locate(const BoundingBox& bounds) const
+	{
+		const glm::vec3 relative = (bounds.getCenter() - m_min) / m_size;
+		if (relative.x < 0.0f || relative.y < 0.0f || relative.z < 0.0f ||
+			relative.x >= 1.0f || relative.y >= 1.0f || relative.z >= 1.0f)
+		{
+			return NodeKey(0, 0, 0, 0);
+		}
+
+		// Deepest level whose cells are at least as wide as the box, the loose bounds then contain it
+		const glm::vec3 size = bounds.max - bounds.min;
+		const float extent = std::max(size.x, std::max(size.y, size.z));
+		uint32_t depth = m_max_depth;
+		if (extent > 0.0f)
+		{
+			const int level = std::ilogb(m_size / extent);
+			depth = level < 0 ? 0 : std::min(static_cast<uint32_t>(level), m_max_depth);
+		}
+
+		const float cells = static_cast<float>(1u << depth);
+		const uint32_t max_cell = (1u << depth) - 1;
+		const uint32_t x = std::min(static_cast<uint32_t>(relative.x * cells), max_cell);
+		const uint32_t y = std::min(static_cast<uint32_t>(relative.y * cells), max_cell);
+		const uint32_t z = std::min(static_cast<uint32_t>(relative.z * cells), max_cell);
+		return NodeKey(depth, x, y, z);
+	}
+
+	uint32_t LooseOctree::findOrCreateNode(uint64_t key)
+	{
+		auto iterator = m_node_lookup.find(key);
+		if (iterator != m_node_lookup.end())
+			return iterator->second;
+
+		const uint32_t depth = static_cast<uint32_t>(key >> 48);
+		const uint32_t x = static_cast<uint32_t>(key >> 32) & 0xFFFF;
+		const uint32_t y = static_cast<uint32_t>(key >> 16) & 0xFFFF;
+		const uint32_t z = static_cast<uint32_t>(key) & 0xFFFF;
+
+		// Missing ancestors are created on the way, the root always exists so this ends
+		const uint32_t parent = findOrCreateNode(NodeKey(depth - 1, x >> 1, y >> 1, z >> 1));
+
+		Node node{};
+		const float cell_size = m_size / static_cast<float>(1u << depth);
+		node.center[0] = m_min.x + (x + 0.5f) * cell_size;
+		node.center[1] = m_min.y + (y + 0.5f) * cell_size;
+		node.center[2] = m_min.z + (z + 0.5f) * cell_size;
+		node.half_size = cell_size * 0.5f;
+		std::fill(std::begin(node.children), std::end(node.children), NONE);
+		node.parent = parent;
+		node.first_proxy = NONE;
+		node.key = key;
+
+		uint32_t index;
+		if (!m_free_nodes.empty())
+		{
+			index = m_free_nodes.back();
+			m_free_nodes.pop_back();
+			m_nodes[index] = node;
+		}
+		else
+		{
+			index = static_cast<uint32_t>(m_nodes.size());
+			m_nodes.push_back(node);
+		}
+
+		const uint32_t slot = (x & 1) | ((y & 1) << 1) | ((z & 1) << 2);
+		m_nodes[parent].children[slot] = index;
+		m_nodes[parent].child_count++;
+		m_node_lookup[key] = index;
+		return index;
+	}
+
+	void LooseOctree::link(uint32_t proxy, uint32_t node)
+	{
+		Proxy& entry = m_proxies[proxy];
+		Node& target = m_nodes[node];
+		entry.node = node;
+		entry.prev = NONE;
+		entry.next = target.first_proxy;
+		if (target.first_proxy != NONE)
+			m_proxies[target.first_proxy].prev = proxy;
+		target.first_proxy = proxy;
+		target.proxy_count++;
+	}
+
+	void LooseOctree::unlink(uint32_t proxy)
+	{
+		Proxy& entry = m_proxies[proxy];
+		Node& node = m_nodes[entry.node];
+		if (entry.prev != NONE)
+			m_proxies[entry.prev].next = entry.next;
+		else
+			node.first_proxy = entry.next;
+		if (entry.next != NONE)
+			m_proxies[entry.next].prev = entry.prev;
+		node.proxy_count--;
+	}
+
+	void LooseOctree::prune(uint32_t node)
+	{
+		// Drop empty leaves so a scene streaming through the world does not leave nodes behind
+		while (node != 0 && m_nodes[node].proxy_count == 0 && m_nodes[node].child_count == 0)
+		{
+			Node& parent = m_nodes[m_nodes[node].parent];
+			for (auto& child : parent.children)
+			{
+				if (child == node)
+				{
+					child = NONE;
+					break;
+				}
+			}
+			parent.child_count--;
+
+			m_node_lookup.erase(m_nodes[node].key);
+			m_free_nodes.push_back(node);
+			node = m_nodes[node].parent;
+		}
+	}
+
+	template<typename NodeTest, typename ProxyTest>
+	size_t LooseOctree::query(NodeTest&& node_test, ProxyTest&& proxy_test, uint32_t* out_user_data, size_t capacity) const
+	{
+		// Depth first, at most seven siblings wait on the stack per level
+		uint32_t stack[MAX_DEPTH_LIMIT * 7 + 8];
+		uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		size_t count = 0;
+		while (stack_size > 0)
+		{
+			const Node& node = m_nodes[stack[--stack_size]];
+
+			for (uint32_t proxy = node.first_proxy; proxy != NONE; proxy = m_proxies[proxy].next)
+			{
+				if (!proxy_test(m_proxies[proxy].bounds))
+					continue;
+				if (count < capacity)
+					out_user_data[count] = m_proxies[proxy].user_data;
+				count++;
+			}
+
+			for (uint32_t child : node.children)
+			{
+				if (child != NONE && node_test(LooseMin(m_nodes[child].center, m_nodes[child].half_size), LooseMax(m_nodes[child].center, m_nodes[child].half_size)))
+					stack[stack_size++] = child;
+			}
+		}
+		return count;
+	}
+
+	size_t LooseOctree::queryBox(const BoundingBox& box, uint32_t* out_user_data, size_t capacity) const
+	{
+		return query(
+			[&](const glm::vec3& node_min, const glm::vec3& node_max) { return Overlaps(box, node_min, node_max); },
+			[&](const BoundingBox& bounds) { return Overlaps(box, bounds.min, bounds.max); },
+			out_user_data, capacity);
+	}
+
+	size_t LooseOctree::queryRadius(const glm::vec3& center, float radius, uint32_t* out_user_data, size_t capacity) const
+	{
+		const float radius_squared = radius * radius;
+		return query(
+			[&](const glm::vec3& node_min, const glm::vec3& node_max) { return DistanceSquared(center, node_min, node_max) <= radius_squared; },
+			[&](const BoundingBox& bounds) { return DistanceSquared(center, bounds.min, bounds.max) <= radius_squared; },
+			out_user_data, capacity);
+	}
+
+	size_t LooseOctree::queryNearest(const glm::vec3& point, size_t k, uint32_t* out_user_data, float* out_distances) const
+	{
+		if (k == 0)
+			return 0;
+
+		// Best k so far, sorted by squared distance. The distances live in the caller's buffer when
+		// given, otherwise on the stack for small k.
+		float local_distances[64];
+		float* distances = out_distances;
+		if (!distances)
+		{
+			assert(k <= 64 && "Pass out_distances for more than 64 neighbours");
+			k = std::min<size_t>(k, 64);
+			distances = local_distances;
+		}
+
+		size_t found = 0;
+		auto worst = [&]() {
+			return found < k ? std::numeric_limits<float>::max() : distances[k - 1];
+		};
+
+		uint32_t stack[MAX_DEPTH_LIMIT * 7 + 8];
+		uint32_t stack_size = 0;
+		stack[stack_size++] = 0;
+
+		while (stack_size > 0)
+		{
+			const Node& node = m_nodes[stack[--stack_size]];
+
+			// The bound may have tightened since the node was pushed
+			if (node.parent != NONE && DistanceSquared(point, LooseMin(node.center, node.half_size), LooseMax(node.center, node.half_size)) > worst())
+				continue;
+
+			for (uint32_t proxy = node.first_proxy; proxy != NONE; proxy = m_proxies[proxy].next)
+			{
+				const float distance = DistanceSquared(point, m_proxies[proxy].bounds.min, m_proxies[proxy].bounds.max);
+				if (distance >= worst())
+					continue;
+
+				// Insertion into the sorted result, dropping the current worst when full
+				size_t i = std::min(found, k - 1);
+				while (i > 0 && distances[i - 1] > distance)
+				{
+					distances[i] = distances[i - 1];
+					out_user_data[i] = out_user_data[i - 1];
+					i--;
+				}
+				distances[i] = distance;
+				out_user_data[i] = m_proxies[proxy].user_data;
+				found = std::min(found + 1, k);
+			}
+
+			// Push the children farthest first so the nearest is searched next and tightens the bound
+			uint32_t children[8];
+			float child_distances[8];
+			uint32_t child_count = 0;
+			for (uint32_t child : node.children)
+			{
+				if (child == NONE)
+					continue;
+				const float distance = DistanceSquared(point, LooseMin(m_nodes[child].center, m_nodes[child].half_size), LooseMax(m_nodes[child].center, m_nodes[child].half_size));
+				if (distance > worst())
+					continue;
+
+				uint32_t i = child_count++;
+				while (i > 0 && child_distances[i - 1] < distance)
+				{
+					child_distances[i] = child_distances[i - 1];
+					children[i] = children[i - 1];
+					i--;
+				}
+				child_distances[i] = distance;
+				children[i] = child;
+			}
+			for (uint32_t i = 0; i < child_count; i++)
+			{
+				stack[stack_size++] = children[i];
+			}
+		}
+
+		if (out_distances)
+		{
+			for (size_t i = 0; i < found; i++)
+			{
+				out_distances[i] = std::sqrt(out_distances[i]);
+			}
+		}
+		return found;
+	}
+}
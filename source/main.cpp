@@ -13,6 +13,7 @@
 #include "camera.hpp"
 #include "generator_geometry.hpp"
 #include "shader_manager.hpp"
+#include "log.hpp"
 
 struct ImgData
 {
@@ -27,16 +28,16 @@ void printMaxVertexAttrib()
 {
     int maxAttributes;
     glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttributes);
-    std::cout << "Maxmimum number of vertex attributes supported: " << maxAttributes << std::endl;
+    XPLOR_LOG_INFO(Render, "Maximum number of vertex attributes supported: %d", maxAttributes);
 
 }
 
 void createSceneA()
 {
     //------ Object Creation
-    std::shared_ptr<Xplor::PropObject> planeA = std::make_shared<Xplor::PropObject>();
-    std::shared_ptr<Xplor::PropObject> cubeA = std::make_shared<Xplor::PropObject>();
-    std::shared_ptr<Xplor::PropObject> cubeB = std::make_shared<Xplor::PropObject>();
+    std::shared_ptr<Xplor::PropObject> planeA = Xplor::MakePooled<Xplor::PropObject>();
+    std::shared_ptr<Xplor::PropObject> cubeA = Xplor::MakePooled<Xplor::PropObject>();
+    std::shared_ptr<Xplor::PropObject> cubeB = Xplor::MakePooled<Xplor::PropObject>();
 
     planeA->setName("Metal Plane");
     cubeA->setName("Box Dog");
@@ -81,7 +82,7 @@ void createSceneA()
         catch (const std::runtime_error& error)
         {
             __debugbreak(); // Windows only
-            std::cerr << "Caught runtime error: " << error.what() << std::endl;
+            XPLOR_LOG_ERROR(Core, "Caught runtime error: %s", error.what());
         }
     }
 
@@ -96,16 +97,7 @@ void createSceneA()
 
     // cubeBBOX
 
-    //------ Define shader uniforms
-    shader_one_tex->useProgram();
-    shader_one_tex->setUniform("customTexture1", 0);
-    shader_one_tex->endProgram();
-
-    shader_simple->useProgram();
-    // Inform the shader where the texture samplers are located
-    shader_simple->setUniform("customTexture1", 0);
-    shader_simple->setUniform("customTexture2", 1);
-    shader_simple->endProgram();
+    // Texture sampler uniforms are set on each object's material by initTextures
 
     auto geometryPlane = GeometryGenerator::GeneratePlaneData();
     auto planeEBO = GeometryGenerator::GeneratePlaneEBO();
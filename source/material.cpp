@@ -0,0 +1,349 @@
+#include "material.hpp"
+
+#include <cstring>
+
+namespace Xplor
+{
+	uint32_t Material::s_next_id = 1;
+
+	namespace
+	{
+		// Size of each parameter type in bytes, also its size in a std140 block where a mat4 is
+		// four vec4 columns
+		uint32_t ParameterSize(MaterialParameterType type)
+		{
+			switch (type)
+			{
+			case MaterialParameterType::Int:
+			case MaterialParameterType::Float:
+				return 4;
+			case MaterialParameterType::Vec2:
+				return 8;
+			case MaterialParameterType::Vec3:
+				return 12;
+			case MaterialParameterType::Vec4:
+				return 16;
+			case MaterialParameterType::Mat4:
+				return 64;
+			default:
+				assert(false && "Undefined enum value in switch statement");
+				return 0;
+			}
+		}
+
+		uint32_t ParameterComponents(MaterialParameterType type)
+		{
+			return ParameterSize(type) / 4;
+		}
+	}
+
+	Material::Material()
+		: m_id(s_next_id++)
+	{
+	}
+
+	Material::Material(std::shared_ptr<Shader> shader)
+		: m_shader(shader), m_id(s_next_id++)
+	{
+	}
+
+	Material::~Material()
+	{
+		if (m_ubo)
+			glDeleteBuffers(1, &m_ubo);
+	}
+
+	void Material::setShader(std::shared_ptr<Shader> shader)
+	{
+		m_shader = shader;
+		m_locations_resolved = false;
+		m_dirty = true;
+	}
+
+	void Material::setInt(StringId name, int value)
+	{
+		setParameter(name, MaterialParameterType::Int, &value);
+	}
+
+	void Material::setFloat(StringId name, float value)
+	{
+		setParameter(name, MaterialParameterType::Float, &value);
+	}
+
+	void Material::setVec2(StringId name, const glm::vec2& value)
+	{
+		setParameter(name, MaterialParameterType::Vec2, &value[0]);
+	}
+
+	void Material::setVec3(StringId name, const glm::vec3& value)
+	{
+		setParameter(name, MaterialParameterType::Vec3, &value[0]);
+	}
+
+	void Material::setVec4(StringId name, const glm::vec4& value)
+	{
+		setParameter(name, MaterialParameterType::Vec4, &value[0]);
+	}
+
+	void Material::setMat4(StringId name, const glm::mat4& value)
+	{
+		setParameter(name, MaterialParameterType::Mat4, &value[0][0]);
+	}
+
+	void Material::setTexture(uint32_t slot, uint32_t texture, StringId sampler_name)
+	{
+		bool found = false;
+		for (auto& binding : m_textures)
+		{
+			if (binding.slot == slot)
+			{
+				binding.texture = texture;
+				found = true;
+			}
+		}
+		if (!found)
+			m_textures.push_back({ slot, texture });
+
+		if (!sampler_name.empty())
+			setInt(sampler_name, static_cast<int>(slot));
+	}
+
+	void Material::setParameter(StringId name, MaterialParameterType type, const void* value)
+	{
+		const uint32_t size = ParameterSize(type);
+
+		for (const auto& parameter : m_parameters)
+		{
+			if (parameter.name != name)
+				continue;
+
+			assert(parameter.type == type && "Material parameter set with a different type");
+
+			// Writing the same value again should not trigger an upload
+			uint8_t* destination = m_values.data() + parameter.offset;
+			if (std::memcmp(destination, value, size) != 0)
+			{
+				std::memcpy(destination, value, size);
+				m_dirty = true;
+			}
+			return;
+		}
+
+		// New parameter, where it goes in the program is only known once locations are resolved
+		const uint32_t offset = static_cast<uint32_t>(m_values.size());
+		m_values.resize(offset + size);
+		std::memcpy(m_values.data() + offset, value, size);
+
+		m_parameters.push_back({ name, type, offset });
+		m_locations_resolved = false;
+		m_dirty = true;
+	}
+
+	void Material::resolveLocations()
+	{
+		const GLuint program = m_shader->getID();
+
+		// The binding point itself is assigned by Shader::init
+		m_block_index = glGetUniformBlockIndex(program, BLOCK_NAME);
+
+		GLint block_size = 0;
+		if (m_block_index != GL_INVALID_INDEX)
+			glGetActiveUniformBlockiv(program, m_block_index, GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+		m_block.assign(static_cast<size_t>(block_size), 0);
+
+		// Block members have no location, their offsets come from the program's layout instead
+		for (auto& parameter : m_parameters)
+		{
+			parameter.location = -1;
+			parameter.block_offset = -1;
+
+			const char* name = parameter.name.c_str();
+			GLuint index = GL_INVALID_INDEX;
+			glGetUniformIndices(program, 1, &name, &index);
+			if (index == GL_INVALID_INDEX)
+				continue;
+
+			GLint block = -1;
+			glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+			if (block == -1)
+			{
+				parameter.location = m_shader->getUniformLocation(parameter.name);
+				continue;
+			}
+
+			if (static_cast<GLuint>(block) != m_block_index)
+				continue;
+
+			GLint block_offset = -1;
+			glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &block_offset);
+			if (block_offset >= 0 && static_cast<size_t>(block_offset) + ParameterSize(parameter.type) <= m_block.size())
+				parameter.block_offset = block_offset;
+		}
+
+		m_locations_resolved = true;
+	}
+
+	void Material::upload(StatCounts& stats)
+	{
+		// Block parameters live in the material's own buffer, so they only need sending when changed.
+		// Members the material never set stay zero, the buffer is bound even when it set none.
+		if (m_dirty && !m_block.empty())
+		{
+			for (const auto& parameter : m_parameters)
+			{
+				if (parameter.block_offset != -1)
+					std::memcpy(m_block.data() + parameter.block_offset, m_values.data() + parameter.offset, ParameterSize(parameter.type));
+			}
+
+			if (!m_ubo)
+				glGenBuffers(1, &m_ubo);
+
+			// The size only changes with the program, which re-resolves and resizes the staging copy
+			glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+			glBufferData(GL_UNIFORM_BUFFER, m_block.size(), m_block.data(), GL_DYNAMIC_DRAW);
+			stats.add(Stat::BufferBytes, m_block.size());
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+
+		// Default block uniforms are program state and have to be re-sent whenever
+		// another material used the program in between
+		for (const auto& parameter : m_parameters)
+		{
+			if (parameter.location == -1)
+				continue;
+
+			const uint8_t* data = m_values.data() + parameter.offset;
+			switch (parameter.type)
+			{
+			case MaterialParameterType::Int:
+				glUniform1iv(parameter.location, 1, reinterpret_cast<const GLint*>(data));
+				break;
+			case MaterialParameterType::Float:
+				glUniform1fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data));
+				break;
+			case MaterialParameterType::Vec2:
+				glUniform2fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data));
+				break;
+			case MaterialParameterType::Vec3:
+				glUniform3fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data));
+				break;
+			case MaterialParameterType::Vec4:
+				glUniform4fv(parameter.location, 1, reinterpret_cast<const GLfloat*>(data));
+				break;
+			case MaterialParameterType::Mat4:
+				glUniformMatrix4fv(parameter.location, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(data));
+				break;
+			default:
+				assert(false && "Undefined enum value in switch statement");
+			}
+		}
+
+		m_dirty = false;
+		m_shader->setBoundMaterial(m_id);
+	}
+
+	void Material::bind(StatCounts& stats)
+	{
+		if (!m_shader)
+		{
+			assert(false && "Material has no shader to bind");
+			return;
+		}
+
+		m_shader->useProgram();
+
+		if (!m_locations_resolved)
+		{
+			resolveLocations();
+			m_dirty = true;
+		}
+
+		if (m_dirty || m_shader->getBoundMaterial() != m_id)
+			upload(stats);
+
+		if (m_ubo)
+			glBindBufferBase(GL_UNIFORM_BUFFER, BLOCK_BINDING, m_ubo);
+
+		for (const auto& binding : m_textures)
+		{
+			glActiveTexture(GL_TEXTURE0 + binding.slot);
+			glBindTexture(GL_TEXTURE_2D, binding.texture);
+		}
+		stats.add(Stat::TexturesBound, m_textures.size());
+	}
+
+	void Material::unbind() const
+	{
+		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+		if (m_shader)
+			m_shader->endProgram();
+	}
+
+	uint64_t Material::getSortKey() const
+	{
+		uint64_t program = m_shader ? m_shader->getID() : 0;
+		return (program << 32) | m_id;
+	}
+
+	json Material::Serialize() const
+	{
+		json parameters = json::array();
+		for (const auto& parameter : m_parameters)
+		{
+			const uint8_t* data = m_values.data() + parameter.offset;
+			json values = json::array();
+			for (uint32_t i = 0; i < ParameterComponents(parameter.type); i++)
+			{
+				if (parameter.type == MaterialParameterType::Int)
+				{
+					int value;
+					std::memcpy(&value, data + i * 4, sizeof(int));
+					values.push_back(value);
+				}
+				else
+				{
+					float value;
+					std::memcpy(&value, data + i * 4, sizeof(float));
+					values.push_back(value);
+				}
+			}
+
+			parameters.push_back({
+				{ "name", parameter.name },
+				{ "type", parameter.type },
+				{ "values", values }
+			});
+		}
+
+		return {
+			{ "parameters", parameters }
+		};
+	}
+
+	void Material::Deserialize(const json& j)
+	{
+		for (const auto& parameter : j.at("parameters"))
+		{
+			auto name = parameter.at("name").get<StringId>();
+			auto type = parameter.at("type").get<MaterialParameterType>();
+			const auto& values = parameter.at("values");
+
+			uint8_t data[64]{};
+			for (uint32_t i = 0; i < ParameterComponents(type) && i < values.size(); i++)
+			{
+				if (type == MaterialParameterType::Int)
+				{
+					int value = values[i].get<int>();
+					std::memcpy(data + i * 4, &value, sizeof(int));
+				}
+				else
+				{
+					float value = values[i].get<float>();
+					std::memcpy(data + i * 4, &value, sizeof(float));
+				}
+			}
+
+			setParameter(name, type, data);
+		}
+	}
+}
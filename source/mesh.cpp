@@ -0,0 +1,197 @@
+#include "mesh.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+namespace Xplor
+{
+	namespace
+	{
+		// Per ray setup of the watertight test (Woop, Benthin, Wald 2013). The ray is sheared so it
+		// points along +z, after which every edge test is a 2D cross product that treats shared
+		// edges identically for both triangles.
+		struct WatertightRay {
+			int kx, ky, kz;
+			float shear_x, shear_y, shear_z;
+			glm::vec3 origin;
+
+			explicit WatertightRay(const Ray& ray)
+				: origin(ray.origin)
+			{
+				const glm::vec3 direction_abs = glm::abs(ray.direction);
+				kz = 0;
+				if (direction_abs.y > direction_abs[kz])
+					kz = 1;
+				if (direction_abs.z > direction_abs[kz])
+					kz = 2;
+				kx = (kz + 1) % 3;
+				ky = (kx + 1) % 3;
+				// Keep the winding so the sign tests below stay consistent
+				if (ray.direction[kz] < 0.0f)
+					std::swap(kx, ky);
+
+				shear_x = ray.direction[kx] / ray.direction[kz];
+				shear_y = ray.direction[ky] / ray.direction[kz];
+				shear_z = 1.0f / ray.direction[kz];
+			}
+		};
+
+		bool IntersectTriangle(const WatertightRay& ray, const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2, float max_t, float& out_t, glm::vec3& out_barycentrics)
+		{
+			const glm::vec3 a = v0 - ray.origin;
+			const glm::vec3 b = v1 - ray.origin;
+			const glm::vec3 c = v2 - ray.origin;
+
+			const float ax = a[ray.kx] - ray.shear_x * a[ray.kz];
+			const float ay = a[ray.ky] - ray.shear_y * a[ray.kz];
+			const float bx = b[ray.kx] - ray.shear_x * b[ray.kz];
+			const float by = b[ray.ky] - ray.shear_y * b[ray.kz];
+			const float cx = c[ray.kx] - ray.shear_x * c[ray.kz];
+			const float cy = c[ray.ky] - ray.shear_y * c[ray.kz];
+
+			float u = cx * by - cy * bx;
+			float v = ax * cy - ay * cx;
+			float w = bx * ay - by * ax;
+
+			// Exactly on an edge, redo the edge tests in double precision
+			if (u == 0.0f || v == 0.0f || w == 0.0f)
+			{
+				u = static_cast<float>(static_cast<double>(cx) * by - static_cast<double>(cy) * bx);
+				v = static_cast<float>(static_cast<double>(ax) * cy - static_cast<double>(ay) * cx);
+				w = static_cast<float>(static_cast<double>(bx) * ay - static_cast<double>(by) * ax);
+			}
+
+			// Both windings count, picking should work from either side of a plane
+			if ((u < 0.0f || v < 0.0f || w < 0.0f) && (u > 0.0f || v > 0.0f || w > 0.0f))
+				return false;
+
+			const float determinant = u + v + w;
+			if (determinant == 0.0f)
+				return false;
+
+			const float az = ray.shear_z * a[ray.kz];
+			const float bz = ray.shear_z * b[ray.kz];
+			const float cz = ray.shear_z * c[ray.kz];
+			const float t = (u * az + v * bz + w * cz) / determinant;
+			if (t < 0.0f || t > max_t)
+				return false;
+
+			out_t = t;
+			out_barycentrics = glm::vec3(u, v, w) / determinant;
+			return true;
+		}
+	}
+
+	bool Mesh::matches(const Geometry& geometry) const
+	{
+		const size_t stride = geometry.GetStep();
+		const float* data = geometry.GetData();
+		if (!data || stride < 3)
+			return false;
+
+		const size_t vertex_count = geometry.GetSize() / stride;
+		if (vertex_count != m_positions.size())
+			return false;
+
+		for (size_t i = 0; i < vertex_count; i++)
+		{
+			const glm::vec3& position = m_positions[i];
+			if (position.x != data[i * stride] || position.y != data[i * stride + 1] || position.z != data[i * stride + 2])
+				return false;
+		}
+
+		// Same rules as the constructor: the EBO if there is one, otherwise the vertices in order
+		const size_t index_count = (geometry.GetEBO() ? geometry.GetEBOSize() : vertex_count) / 3 * 3;
+		if (index_count != m_indices.size())
+			return false;
+
+		for (size_t i = 0; i < index_count; i++)
+		{
+			const uint32_t index = geometry.GetEBO() ? geometry.GetEBO()[i] : static_cast<uint32_t>(i);
+			if (index != m_indices[i])
+				return false;
+		}
+		return true;
+	}
+
+	Mesh::Mesh(const Geometry& geometry)
+	{
+		const size_t stride = geometry.GetStep();
+		const float* data = geometry.GetData();
+		if (!data || stride < 3)
+		{
+			assert(false && "Mesh needs vertex data with at least a position per vertex");
+			return;
+		}
+
+		const size_t vertex_count = geometry.GetSize() / stride;
+		m_positions.reserve(vertex_count);
+		for (size_t i = 0; i < vertex_count; i++)
+		{
+			m_positions.emplace_back(data[i * stride], data[i * stride + 1], data[i * stride + 2]);
+		}
+
+		// Indexed geometry lists its triangles in the EBO, otherwise vertices are consumed in order
+		if (geometry.GetEBO())
+		{
+			m_indices.assign(geometry.GetEBO(), geometry.GetEBO() + geometry.GetEBOSize());
+		}
+		else
+		{
+			for (uint32_t i = 0; i < vertex_count; i++)
+			{
+				m_indices.push_back(i);
+			}
+		}
+		m_indices.resize(m_indices.size() / 3 * 3);
+
+		if (!m_positions.empty())
+		{
+			m_local_bounds = { m_positions[0], m_positions[0] };
+			for (const auto& position : m_positions)
+			{
+				m_local_bounds.min = glm::min(m_local_bounds.min, position);
+				m_local_bounds.max = glm::max(m_local_bounds.max, position);
+			}
+
+			// Centring on the box keeps the sphere offset equal to the box offset once transformed
+			m_local_sphere.center = m_local_bounds.getCenter();
+			for (const auto& position : m_positions)
+			{
+				m_local_sphere.radius = std::max(m_local_sphere.radius, glm::length(position - m_local_sphere.center));
+			}
+		}
+
+		std::vector<BoundingBox> triangle_bounds(getTriangleCount());
+		for (uint32_t triangle = 0; triangle < triangle_bounds.size(); triangle++)
+		{
+			const glm::vec3& v0 = getVertex(triangle, 0);
+			const glm::vec3& v1 = getVertex(triangle, 1);
+			const glm::vec3& v2 = getVertex(triangle, 2);
+			triangle_bounds[triangle] = { glm::min(v0, glm::min(v1, v2)), glm::max(v0, glm::max(v1, v2)) };
+		}
+		m_bvh.build(triangle_bounds);
+	}
+
+	bool Mesh::intersect(const Ray& ray, float max_t, MeshHit& out_hit) const
+	{
+		const WatertightRay watertight(ray);
+		bool hit = false;
+
+		m_bvh.traverse(ray, max_t, [&](uint32_t triangle, float) {
+			float t;
+			glm::vec3 barycentrics;
+			if (IntersectTriangle(watertight, getVertex(triangle, 0), getVertex(triangle, 1), getVertex(triangle, 2), max_t, t, barycentrics))
+			{
+				max_t = t;
+				out_hit = { triangle, t, barycentrics };
+				hit = true;
+			}
+			return max_t;
+		});
+
+		return hit;
+	}
+}
@@ -0,0 +1,66 @@
+#include "mesh_manager.hpp"
+#include "pool_allocator.hpp"
+
+namespace Xplor
+{
+	namespace
+	{
+		constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+		constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+		void HashBytes(uint64_t& hash, const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			for (size_t i = 0; i < size; i++)
+			{
+				hash ^= bytes[i];
+				hash *= FNV_PRIME;
+			}
+		}
+	}
+
+	std::shared_ptr<const Mesh> MeshManager::getMesh(const Geometry& geometry)
+	{
+		const uint64_t hash = hashGeometry(geometry);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Equal hashes usually mean equal geometry, the contents decide in case two meshes collide
+		std::vector<std::shared_ptr<const Mesh>>& meshes = m_hash_to_mesh[hash];
+		for (const auto& mesh : meshes)
+		{
+			if (mesh->matches(geometry))
+				return mesh;
+		}
+
+		std::shared_ptr<const Mesh> mesh = MakePooled<Mesh>(geometry);
+		meshes.push_back(mesh);
+		m_mesh_count++;
+		return mesh;
+	}
+
+	size_t MeshManager::getMeshCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_mesh_count;
+	}
+
+	uint64_t MeshManager::hashGeometry(const Geometry& geometry)
+	{
+		// FNV-1a over everything that shapes the triangles
+		uint64_t hash = FNV_OFFSET;
+		const size_t step = geometry.GetStep();
+		const uint32_t index_count = geometry.GetIndexCount();
+		HashBytes(hash, &step, sizeof(step));
+		HashBytes(hash, &index_count, sizeof(index_count));
+		if (geometry.GetData())
+		{
+			HashBytes(hash, geometry.GetData(), geometry.GetSize() * sizeof(float));
+		}
+		if (geometry.GetEBO())
+		{
+			HashBytes(hash, geometry.GetEBO(), geometry.GetEBOSize() * sizeof(unsigned int));
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,139 @@
+#include "pool_allocator.hpp"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace Xplor
+{
+	namespace
+	{
+		struct PoolRegistry {
+			std::mutex mutex;
+			std::vector<const BlockPool*> pools;
+		};
+
+		PoolRegistry& GetRegistry()
+		{
+			// Never destroyed, like the pools registered in it
+			static PoolRegistry* registry = new PoolRegistry();
+			return *registry;
+		}
+	}
+
+	BlockPool::BlockPool(std::string name, size_t block_size, size_t blocks_per_chunk)
+		: m_name(std::move(name)), m_block_size(block_size), m_blocks_per_chunk(std::max<size_t>(blocks_per_chunk, 1))
+	{
+		if (m_block_size != 0)
+			m_block_size = std::max(m_block_size, sizeof(FreeBlock));
+
+		PoolRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		registry.pools.push_back(this);
+	}
+
+	BlockPool::~BlockPool()
+	{
+		{
+			PoolRegistry& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.pools.erase(std::remove(registry.pools.begin(), registry.pools.end(), this), registry.pools.end());
+		}
+
+		assert(m_live == 0 && "Destroying a pool with blocks still in use");
+		for (void* chunk : m_chunks)
+		{
+			::operator delete(chunk, std::align_val_t(m_alignment));
+		}
+	}
+
+	void* BlockPool::allocate(size_t bytes, size_t alignment)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// Pools for std::allocate_shared only learn the size of the control block here
+		if (m_chunks.empty())
+		{
+			m_alignment = std::max(m_alignment, alignment);
+			const size_t size = std::max({ m_block_size, bytes, sizeof(FreeBlock) });
+			m_block_size = (size + m_alignment - 1) & ~(m_alignment - 1);
+		}
+		assert(bytes <= m_block_size && alignment <= m_alignment && "Allocation does not fit the pool's blocks");
+
+		if (!m_free)
+			addChunk();
+
+		FreeBlock* block = m_free;
+		m_free = block->next;
+		m_live++;
+		m_peak = std::max(m_peak, m_live);
+		m_allocations++;
+		return block;
+	}
+
+	void BlockPool::deallocate(void* block)
+	{
+		if (!block)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		FreeBlock* free_block = static_cast<FreeBlock*>(block);
+		free_block->next = m_free;
+		m_free = free_block;
+		m_live--;
+	}
+
+	BlockPool::Stats BlockPool::getStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return { m_block_size, m_live, m_peak, m_chunks.size() * m_blocks_per_chunk, m_chunks.size(), m_allocations };
+	}
+
+	void BlockPool::addChunk()
+	{
+		std::byte* chunk = static_cast<std::byte*>(::operator new(m_block_size * m_blocks_per_chunk, std::align_val_t(m_alignment)));
+		m_chunks.push_back(chunk);
+
+		// Linked back to front so blocks are handed out in address order
+		for (size_t i = m_blocks_per_chunk; i-- > 0;)
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * m_block_size);
+			block->next = m_free;
+			m_free = block;
+		}
+	}
+
+	std::string GetPoolName(const std::type_info& type)
+	{
+		std::string name = type.name();
+#if defined(__GNUG__)
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+		if (status == 0 && demangled)
+			name = demangled;
+		std::free(demangled);
+#endif
+		// MSVC names are readable but prefixed, the namespace is the same for every pool
+		for (const char* prefix : { "class ", "struct ", "Xplor::" })
+		{
+			const size_t length = std::char_traits<char>::length(prefix);
+			if (name.compare(0, length, prefix) == 0)
+				name.erase(0, length);
+		}
+		return name;
+	}
+
+	void VisitPools(void (*visitor)(void* context, const BlockPool& pool), void* context)
+	{
+		PoolRegistry& registry = GetRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		for (const BlockPool* pool : registry.pools)
+		{
+			visitor(context, *pool);
+		}
+	}
+}
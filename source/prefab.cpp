@@ -0,0 +1,19 @@
+#include "prefab.hpp"
+
+#include <cassert>
+
+namespace Xplor
+{
+	Prefab::Prefab(std::shared_ptr<const GameObject> source)
+		: m_source(std::move(source))
+	{
+		assert(m_source && m_source->getMesh() && "Prefabs need an object with initialised geometry");
+	}
+
+	std::shared_ptr<GameObject> Prefab::instantiate() const
+	{
+		std::shared_ptr<GameObject> object = CreateGameObject(m_source->getObjectType());
+		object->initFromPrefab(m_source);
+		return object;
+	}
+}
@@ -0,0 +1,216 @@
+#include "profiler.hpp"
+#include "log.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace Xplor
+{
+	namespace
+	{
+		static_assert((Profiler::EVENTS_PER_THREAD & (Profiler::EVENTS_PER_THREAD - 1)) == 0, "The event ring size has to be a power of two");
+
+		struct Event {
+			const char* name;
+			uint64_t start;
+			uint64_t end;
+		};
+
+		// Single producer ring: the owning thread advances write, the main thread advances read
+		struct ThreadBuffer {
+			std::unique_ptr<Event[]> events; // Allocated by the first recorded event
+			std::atomic<uint64_t> write{};
+			std::atomic<uint64_t> read{};
+			std::atomic<uint64_t> dropped{};
+			uint32_t id{};
+			std::string name;
+			const char* category{ "cpu" };
+		};
+
+		struct ProfilerState {
+			std::mutex mutex; // Guards the thread list and the capture settings, not the rings
+			std::vector<ThreadBuffer*> threads;
+			ThreadBuffer* gpu{}; // Written by the thread owning the OpenGL context
+			uint32_t frames_requested{};
+			std::atomic<uint32_t> frames_left{};
+			uint64_t capture_start{};
+			uint32_t capture_count{};
+			std::string path;
+		};
+
+		// Never destroyed, worker threads may still record while statics are torn down
+		ProfilerState& GetState()
+		{
+			static ProfilerState* state = new ProfilerState();
+			return *state;
+		}
+
+		thread_local ThreadBuffer* t_buffer = nullptr;
+
+		// Caller holds the state mutex
+		ThreadBuffer* AddBuffer(ProfilerState& state, const std::string& name)
+		{
+			ThreadBuffer* buffer = new ThreadBuffer();
+			buffer->id = static_cast<uint32_t>(state.threads.size());
+			buffer->name = name.empty() ? "Thread " + std::to_string(buffer->id) : name;
+			state.threads.push_back(buffer);
+			return buffer;
+		}
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (!t_buffer)
+			{
+				ProfilerState& state = GetState();
+				std::lock_guard<std::mutex> lock(state.mutex);
+				t_buffer = AddBuffer(state, {});
+			}
+			return *t_buffer;
+		}
+
+		void Append(ThreadBuffer& buffer, const char* name, uint64_t start, uint64_t end)
+		{
+			if (!buffer.events)
+				buffer.events = std::make_unique<Event[]>(Profiler::EVENTS_PER_THREAD);
+
+			const uint64_t write = buffer.write.load(std::memory_order_relaxed);
+			if (write - buffer.read.load(std::memory_order_acquire) >= Profiler::EVENTS_PER_THREAD)
+			{
+				buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			buffer.events[write & (Profiler::EVENTS_PER_THREAD - 1)] = { name, start, end };
+			buffer.write.store(write + 1, std::memory_order_release);
+		}
+
+		void WriteTrace(ProfilerState& state)
+		{
+			using json = nlohmann::json;
+
+			json events = json::array();
+			uint64_t dropped = 0;
+			for (ThreadBuffer* buffer : state.threads)
+			{
+				events.push_back({
+					{ "ph", "M" }, { "name", "thread_name" }, { "pid", 1 }, { "tid", buffer->id },
+					{ "args", { { "name", buffer->name } } }
+				});
+
+				const uint64_t write = buffer->write.load(std::memory_order_acquire);
+				for (uint64_t i = buffer->read.load(std::memory_order_relaxed); i < write; i++)
+				{
+					const Event& event = buffer->events[i & (Profiler::EVENTS_PER_THREAD - 1)];
+					if (event.start < state.capture_start)
+						continue;
+
+					// Chrome traces count in microseconds
+					events.push_back({
+						{ "ph", "X" }, { "name", event.name }, { "cat", buffer->category }, { "pid", 1 }, { "tid", buffer->id },
+						{ "ts", (event.start - state.capture_start) / 1000.0 },
+						{ "dur", (event.end - event.start) / 1000.0 }
+					});
+				}
+				buffer->read.store(write, std::memory_order_release);
+				dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+			}
+
+			std::ofstream file(state.path);
+			if (!file)
+			{
+				XPLOR_LOG_ERROR(Core, "Could not write trace to %s", state.path.c_str());
+				return;
+			}
+			file << json{ { "traceEvents", events }, { "displayTimeUnit", "ms" } };
+
+			XPLOR_LOG_INFO(Core, "Wrote %zu trace events to %s", events.size(), state.path.c_str());
+			if (dropped > 0)
+				XPLOR_LOG_WARNING(Core, "%llu trace events were dropped, a thread ring was full", static_cast<unsigned long long>(dropped));
+		}
+	}
+
+	uint64_t Profiler::now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	void Profiler::record(const char* name, uint64_t start, uint64_t end)
+	{
+		Append(GetThreadBuffer(), name, start, end);
+	}
+
+	void Profiler::recordGpu(const char* name, uint64_t start, uint64_t end)
+	{
+		ProfilerState& state = GetState();
+		if (!state.gpu)
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			state.gpu = AddBuffer(state, "GPU");
+			state.gpu->category = "gpu";
+		}
+		Append(*state.gpu, name, start, end);
+	}
+
+	void Profiler::setThreadName(const std::string& name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+		std::lock_guard<std::mutex> lock(GetState().mutex);
+		buffer.name = name;
+	}
+
+	bool Profiler::beginCapture(uint32_t frames, const std::string& path)
+	{
+		ProfilerState& state = GetState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (frames == 0 || state.frames_requested != 0 || state.frames_left.load(std::memory_order_relaxed) != 0)
+			return false;
+
+		state.frames_requested = frames;
+		state.path = path.empty() ? "xplor_trace_" + std::to_string(state.capture_count++) + ".json" : path;
+		return true;
+	}
+
+	void Profiler::endFrame()
+	{
+		ProfilerState& state = GetState();
+
+		const uint32_t frames_left = state.frames_left.load(std::memory_order_relaxed);
+		if (frames_left > 1)
+		{
+			state.frames_left.store(frames_left - 1, std::memory_order_relaxed);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (frames_left == 1)
+		{
+			// Scopes still open keep their start time and record anyway, they are filtered out next time
+			m_capturing.store(false, std::memory_order_relaxed);
+			state.frames_left.store(0, std::memory_order_relaxed);
+			WriteTrace(state);
+		}
+		else if (state.frames_requested != 0)
+		{
+			// Skip whatever was recorded after the last capture ended
+			for (ThreadBuffer* buffer : state.threads)
+			{
+				buffer->read.store(buffer->write.load(std::memory_order_acquire), std::memory_order_release);
+			}
+
+			state.capture_start = now();
+			state.frames_left.store(state.frames_requested, std::memory_order_relaxed);
+			state.frames_requested = 0;
+			m_capturing.store(true, std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t Profiler::getCaptureFramesLeft()
+	{
+		return GetState().frames_left.load(std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,145 @@
+#include "render_thread.hpp"
+#include "profiler.hpp"
+
+#include <future>
+#include "GLFW/glfw3.h"
+
+namespace Xplor
+{
+	RenderThread::~RenderThread()
+	{
+		stop();
+	}
+
+	void RenderThread::start(GLFWwindow* window, Renderer* renderer)
+	{
+		if (m_running)
+			return;
+
+		m_window = window;
+		m_renderer = renderer;
+		m_stop = false;
+		m_pending = -1;
+		m_in_flight = {};
+
+		// A context can only be current on one thread at a time
+		glfwMakeContextCurrent(nullptr);
+		m_running = true;
+		m_thread = std::thread(&RenderThread::threadMain, this);
+	}
+
+	void RenderThread::stop()
+	{
+		if (!m_running)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condition.notify_all();
+		m_thread.join();
+		m_running = false;
+
+		glfwMakeContextCurrent(m_window);
+	}
+
+	FramePacket& RenderThread::acquirePacket()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this] { return !m_in_flight[m_write_index]; });
+		return m_packets[m_write_index];
+	}
+
+	void RenderThread::submit()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			// Only one packet can wait at a time, the previous one has to be picked up first
+			m_condition.wait(lock, [this] { return m_pending == -1; });
+			m_in_flight[m_write_index] = true;
+			m_pending = static_cast<int>(m_write_index);
+			m_write_index ^= 1;
+		}
+		m_condition.notify_all();
+	}
+
+	void RenderThread::waitIdle()
+	{
+		if (!m_running)
+			return;
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this] { return m_pending == -1 && !m_in_flight[0] && !m_in_flight[1]; });
+	}
+
+	void RenderThread::runOnRenderThread(const std::function<void()>& command)
+	{
+		if (!m_running || std::this_thread::get_id() == m_thread.get_id())
+		{
+			command();
+			return;
+		}
+
+		std::packaged_task<void()> task(command);
+		std::future<void> done = task.get_future();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_commands.emplace_back([&task] { task(); });
+		}
+		m_condition.notify_all();
+		done.get();
+	}
+
+	void RenderThread::threadMain()
+	{
+		glfwMakeContextCurrent(m_window);
+		XPLOR_PROFILE_THREAD("Render");
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_condition.wait(lock, [this] { return m_stop || m_pending != -1 || !m_commands.empty(); });
+
+			// Resource work first so the next packet can use what it creates
+			while (!m_commands.empty())
+			{
+				auto command = std::move(m_commands.front());
+				m_commands.pop_front();
+				lock.unlock();
+				command();
+				lock.lock();
+			}
+
+			if (m_pending == -1)
+			{
+				if (m_stop)
+					break;
+				continue;
+			}
+
+			int index = m_pending;
+			m_pending = -1;
+			lock.unlock();
+			m_condition.notify_all(); // Let the simulation submit the next packet
+
+			FramePacket& packet = m_packets[index];
+			m_renderer->execute(packet, packet.render_stats);
+			{
+				XPLOR_PROFILE_SCOPE("Swap Buffers");
+				glfwSwapBuffers(m_window);
+			}
+
+			// The last reference to a material may be the packet's, destroy it with the context current
+			packet.runDeferred();
+			packet.releaseMaterials();
+
+			lock.lock();
+			m_in_flight[index] = false;
+			m_condition.notify_all();
+		}
+		lock.unlock();
+
+		glfwMakeContextCurrent(nullptr);
+	}
+}
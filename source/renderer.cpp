@@ -0,0 +1,115 @@
+#include "renderer.hpp"
+#include "material.hpp"
+#include "shader_manager.hpp"
+#include "imgui_impl_opengl3.h"
+#include "profiler.hpp"
+#include "stats.hpp"
+
+namespace Xplor
+{
+	void Renderer::init()
+	{
+		// Per-frame uniform data, sized for a few thousand draws before it has to grow
+		m_uniform_ring.init(1024 * 1024);
+		m_debug_draw.init();
+		m_gpu_timer.init();
+	}
+
+	void Renderer::shutdown()
+	{
+		m_gpu_timer.destroy();
+		m_debug_draw.destroy();
+		m_uniform_ring.destroy();
+	}
+
+	void Renderer::execute(const FramePacket& packet, StatCounts& out_stats)
+	{
+		XPLOR_PROFILE_SCOPE("Draw");
+		m_gpu_timer.beginFrame();
+
+		//---- Background Color
+		m_gpu_timer.beginPass(GpuPass::Scene);
+		glViewport(0, 0, packet.framebuffer_width, packet.framebuffer_height);
+		glClearColor(packet.clear_color.x, packet.clear_color.y, packet.clear_color.z, packet.clear_color.w);
+		glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+
+		//--- Stream camera and per-draw data into this frame's region of the ring
+		m_uniform_ring.beginFrame();
+		m_debug_draw.beginFrame();
+
+		size_t camera_offset = m_uniform_ring.push(packet.camera);
+
+		m_object_offsets.clear();
+		for (const auto& item : packet.draws)
+		{
+			m_object_offsets.push_back(m_uniform_ring.push(item.uniforms));
+		}
+		m_uniform_ring.flush();
+
+		for (const auto& box : packet.debug_boxes)
+		{
+			m_debug_draw.addBox(box);
+		}
+
+		//--- Scene, draws arrive sorted so the material only changes between groups
+		m_uniform_ring.bindRange(static_cast<GLuint>(UniformBinding::Camera), camera_offset, sizeof(CameraUniforms));
+
+		Material* bound_material = nullptr;
+		uint64_t triangles = 0;
+		uint64_t state_changes = 0;
+		for (size_t i = 0; i < packet.draws.size(); i++)
+		{
+			const DrawItem& item = packet.draws[i];
+			m_uniform_ring.bindRange(static_cast<GLuint>(UniformBinding::Object), m_object_offsets[i], sizeof(ObjectUniforms));
+
+			if (item.material != bound_material)
+			{
+				item.material->bind(out_stats);
+				bound_material = item.material;
+				state_changes++;
+			}
+
+			glBindVertexArray(item.VAO);
+			if (item.indexed)
+				glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(item.element_count), GL_UNSIGNED_INT, 0);
+			else
+				glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(item.element_count));
+			triangles += item.element_count / 3;
+		}
+		glBindVertexArray(0); // Unbind the VAO
+		if (bound_material)
+			bound_material->unbind();
+		m_gpu_timer.endPass(GpuPass::Scene);
+		out_stats.add(Stat::DrawCalls, packet.draws.size());
+		out_stats.add(Stat::Triangles, triangles);
+		out_stats.add(Stat::StateChanges, state_changes);
+
+		//--- Debug lines for every bounding box in one draw
+		if (!packet.debug_boxes.empty())
+		{
+			XPLOR_PROFILE_SCOPE("Draw Bounding Boxes");
+			std::shared_ptr<Shader> bbox_shader;
+			ShaderManager::getInstance()->findShader("bounding"_sid, bbox_shader);
+			m_gpu_timer.beginPass(GpuPass::BoundingBoxes);
+			m_debug_draw.draw(bbox_shader);
+			m_gpu_timer.endPass(GpuPass::BoundingBoxes);
+			out_stats.add(Stat::DrawCalls);
+		}
+
+		out_stats.add(Stat::BufferBytes, m_debug_draw.getUsedSize() + m_uniform_ring.getUsedSize());
+		m_debug_draw.endFrame();
+		m_uniform_ring.endFrame();
+
+		//---- ImGui Rendering
+		XPLOR_PROFILE_SCOPE("Draw UI");
+		ImGui_ImplOpenGL3_NewFrame(); // Creates the backend's device objects on first use
+		if (packet.has_ui)
+		{
+			m_gpu_timer.beginPass(GpuPass::UI);
+			ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(&packet.ui));
+			m_gpu_timer.endPass(GpuPass::UI);
+		}
+
+		m_gpu_timer.endFrame();
+	}
+}
@@ -0,0 +1,436 @@
+#include "scene_bvh.hpp"
+
+#include <algorithm>
+
+#if XPLOR_SIMD_X86
+#include <emmintrin.h>
+#endif
+
+namespace Xplor
+{
+	namespace
+	{
+		// Scratch for the component split of the rays, reused by every intersect call on the thread
+		struct RayScratch {
+			std::vector<float> origin_x, origin_y, origin_z;
+			std::vector<float> inv_direction_x, inv_direction_y, inv_direction_z;
+			std::vector<uint32_t> hit_object;
+			std::vector<float> hit_t;
+		};
+
+		inline void GrowBox(BVHNode& node, const BVHBox& box)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				node.min[axis] = std::min(node.min[axis], box.min[axis]);
+				node.max[axis] = std::max(node.max[axis], box.max[axis]);
+			}
+		}
+
+		inline void GrowBox(BVHNode& node, const BVHNode& child)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				node.min[axis] = std::min(node.min[axis], child.min[axis]);
+				node.max[axis] = std::max(node.max[axis], child.max[axis]);
+			}
+		}
+
+		inline void ResetBox(BVHNode& node)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				node.min[axis] = std::numeric_limits<float>::max();
+				node.max[axis] = -std::numeric_limits<float>::max();
+			}
+		}
+
+		inline BVHBox ToBox(const BoundingBox& bounds)
+		{
+			return { { bounds.min.x, bounds.min.y, bounds.min.z }, { bounds.max.x, bounds.max.y, bounds.max.z } };
+		}
+
+		// Entry and exit distance of one ray, clamped to [0, max_t]
+		inline bool SlabScalar(const float* box_min, const float* box_max, const float origin[3], const float inv_direction[3], float max_t, float& out_near)
+		{
+			// Empty boxes are inverted on every axis, the slab intervals alone would accept them
+			if (box_min[0] > box_max[0])
+				return false;
+
+			float t_near = 0.0f;
+			float t_far = max_t;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float t1 = (box_min[axis] - origin[axis]) * inv_direction[axis];
+				float t2 = (box_max[axis] - origin[axis]) * inv_direction[axis];
+				t_near = std::max(t_near, std::min(t1, t2));
+				t_far = std::min(t_far, std::max(t1, t2));
+			}
+			out_near = t_near;
+			return t_near <= t_far;
+		}
+
+#if XPLOR_SIMD_X86
+		struct PacketSSE {
+			__m128 origin_x, origin_y, origin_z;
+			__m128 inv_x, inv_y, inv_z;
+		};
+
+		// Slab test of one box against four rays, returns the lanes that hit closer than closest
+		inline __m128 SlabSSE(const float* box_min, const float* box_max, const PacketSSE& packet, __m128 closest, __m128& out_near)
+		{
+			if (box_min[0] > box_max[0])
+			{
+				out_near = closest;
+				return _mm_setzero_ps();
+			}
+
+			__m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_min[0]), packet.origin_x), packet.inv_x);
+			__m128 t2x = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_max[0]), packet.origin_x), packet.inv_x);
+			__m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_min[1]), packet.origin_y), packet.inv_y);
+			__m128 t2y = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_max[1]), packet.origin_y), packet.inv_y);
+			__m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_min[2]), packet.origin_z), packet.inv_z);
+			__m128 t2z = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box_max[2]), packet.origin_z), packet.inv_z);
+
+			__m128 t_near = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1x, t2x), _mm_min_ps(t1y, t2y)), _mm_max_ps(_mm_min_ps(t1z, t2z), _mm_setzero_ps()));
+			__m128 t_far = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1x, t2x), _mm_max_ps(t1y, t2y)), _mm_min_ps(_mm_max_ps(t1z, t2z), closest));
+
+			out_near = t_near;
+			return _mm_cmple_ps(t_near, t_far);
+		}
+
+		// Smallest entry distance over the lanes in mask
+		inline float NearestLaneSSE(__m128 t_near, __m128 mask)
+		{
+			alignas(16) float values[4];
+			_mm_store_ps(values, _mm_or_ps(_mm_and_ps(mask, t_near), _mm_andnot_ps(mask, _mm_set1_ps(std::numeric_limits<float>::max()))));
+			return std::min(std::min(values[0], values[1]), std::min(values[2], values[3]));
+		}
+#endif
+	}
+
+	void SceneBVH::build(const std::vector<BoundingBox>& bounds)
+	{
+		const uint32_t count = static_cast<uint32_t>(bounds.size());
+
+		m_items.resize(count);
+		m_centroids.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_items[i] = i;
+			m_centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+		}
+
+		m_nodes.clear();
+		if (count == 0)
+		{
+			m_item_boxes.clear();
+			return;
+		}
+
+		m_nodes.reserve(2 * count - 1);
+		m_nodes.push_back({});
+		m_nodes[0].left_first = 0;
+		m_nodes[0].count = count;
+
+		// Subdividing only reorders m_items, the boxes are copied in leaf order afterwards
+		m_item_boxes.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_item_boxes[i] = ToBox(bounds[i]);
+		}
+		subdivide(0, 0);
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			m_item_boxes[i] = ToBox(bounds[m_items[i]]);
+		}
+	}
+
+	void SceneBVH::updateNodeBounds(uint32_t node_index)
+	{
+		// During the build m_item_boxes is still indexed by item, not by leaf order
+		BVHNode& node = m_nodes[node_index];
+		ResetBox(node);
+		for (uint32_t i = 0; i < node.count; i++)
+		{
+			GrowBox(node, m_item_boxes[m_items[node.left_first + i]]);
+		}
+	}
+
+	void SceneBVH::subdivide(uint32_t node_index, uint32_t depth)
+	{
+		updateNodeBounds(node_index);
+
+		const uint32_t first = m_nodes[node_index].left_first;
+		const uint32_t count = m_nodes[node_index].count;
+		if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH)
+			return;
+
+		// Median split along the longest axis of the centroids keeps the tree balanced
+		glm::vec3 centroid_min = m_centroids[m_items[first]];
+		glm::vec3 centroid_max = centroid_min;
+		for (uint32_t i = first + 1; i < first + count; i++)
+		{
+			centroid_min = glm::min(centroid_min, m_centroids[m_items[i]]);
+			centroid_max = glm::max(centroid_max, m_centroids[m_items[i]]);
+		}
+		glm::vec3 extent = centroid_max - centroid_min;
+		int axis = 0;
+		if (extent.y > extent[axis])
+			axis = 1;
+		if (extent.z > extent[axis])
+			axis = 2;
+
+		const uint32_t half = count / 2;
+		auto begin = m_items.begin() + first;
+		std::nth_element(begin, begin + half, begin + count, [this, axis](uint32_t a, uint32_t b) {
+			return m_centroids[a][axis] < m_centroids[b][axis];
+		});
+
+		const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+		m_nodes.push_back({});
+		m_nodes.push_back({});
+		m_nodes[left].left_first = first;
+		m_nodes[left].count = half;
+		m_nodes[left + 1].left_first = first + half;
+		m_nodes[left + 1].count = count - half;
+
+		m_nodes[node_index].left_first = left;
+		m_nodes[node_index].count = 0;
+
+		subdivide(left, depth + 1);
+		subdivide(left + 1, depth + 1);
+	}
+
+	void SceneBVH::refit(const std::vector<BoundingBox>& bounds)
+	{
+		if (bounds.size() != m_items.size())
+		{
+			build(bounds);
+			return;
+		}
+
+		for (size_t i = 0; i < m_items.size(); i++)
+		{
+			m_item_boxes[i] = ToBox(bounds[m_items[i]]);
+		}
+
+		// Children are always stored after their parent
+		for (size_t i = m_nodes.size(); i-- > 0;)
+		{
+			BVHNode& node = m_nodes[i];
+			ResetBox(node);
+			if (node.count > 0)
+			{
+				for (uint32_t item = 0; item < node.count; item++)
+				{
+					GrowBox(node, m_item_boxes[node.left_first + item]);
+				}
+			}
+			else
+			{
+				GrowBox(node, m_nodes[node.left_first]);
+				GrowBox(node, m_nodes[node.left_first + 1]);
+			}
+		}
+	}
+
+	void SceneBVH::intersect(const Ray* rays, size_t count, RayHit* out_hits) const
+	{
+		thread_local RayScratch scratch;
+		scratch.origin_x.resize(count);
+		scratch.origin_y.resize(count);
+		scratch.origin_z.resize(count);
+		scratch.inv_direction_x.resize(count);
+		scratch.inv_direction_y.resize(count);
+		scratch.inv_direction_z.resize(count);
+		scratch.hit_object.assign(count, RayHit::NO_HIT);
+		scratch.hit_t.assign(count, std::numeric_limits<float>::max());
+
+		for (size_t i = 0; i < count; i++)
+		{
+			scratch.origin_x[i] = rays[i].origin.x;
+			scratch.origin_y[i] = rays[i].origin.y;
+			scratch.origin_z[i] = rays[i].origin.z;
+			scratch.inv_direction_x[i] = rays[i].direction_inv.x;
+			scratch.inv_direction_y[i] = rays[i].direction_inv.y;
+			scratch.inv_direction_z[i] = rays[i].direction_inv.z;
+		}
+
+		if (!m_nodes.empty())
+		{
+			RayStreams streams{
+				scratch.origin_x.data(), scratch.origin_y.data(), scratch.origin_z.data(),
+				scratch.inv_direction_x.data(), scratch.inv_direction_y.data(), scratch.inv_direction_z.data(),
+				scratch.hit_object.data(), scratch.hit_t.data(), count
+			};
+
+			switch (GetSimdLevel())
+			{
+#if XPLOR_SIMD_X86
+			case SimdLevel::AVX:
+				Detail::IntersectBVHAVX(m_nodes.data(), m_item_boxes.data(), m_items.data(), streams);
+				break;
+			case SimdLevel::SSE:
+				Detail::IntersectBVHSSE(m_nodes.data(), m_item_boxes.data(), m_items.data(), streams);
+				break;
+#endif
+			default:
+				Detail::IntersectBVHScalar(m_nodes.data(), m_item_boxes.data(), m_items.data(), streams);
+			}
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			out_hits[i].object = scratch.hit_object[i];
+			out_hits[i].t = scratch.hit_object[i] == RayHit::NO_HIT ? -1.0f : scratch.hit_t[i];
+		}
+	}
+
+	namespace Detail
+	{
+		void IntersectBVHScalar(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays)
+		{
+			uint32_t stack[SceneBVH::MAX_DEPTH * 2];
+
+			for (size_t ray = 0; ray < rays.count; ray++)
+			{
+				const float origin[3] = { rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray] };
+				const float inv_direction[3] = { rays.inv_direction_x[ray], rays.inv_direction_y[ray], rays.inv_direction_z[ray] };
+				float closest = rays.hit_t[ray];
+				uint32_t closest_object = rays.hit_object[ray];
+
+				uint32_t stack_size = 0;
+				stack[stack_size++] = 0;
+				while (stack_size > 0)
+				{
+					const BVHNode& node = nodes[stack[--stack_size]];
+					float t_near;
+					if (!SlabScalar(node.min, node.max, origin, inv_direction, closest, t_near))
+						continue;
+
+					if (node.count > 0)
+					{
+						for (uint32_t i = node.left_first; i < node.left_first + node.count; i++)
+						{
+							if (SlabScalar(item_boxes[i].min, item_boxes[i].max, origin, inv_direction, closest, t_near) && t_near < closest)
+							{
+								closest = t_near;
+								closest_object = items[i];
+							}
+						}
+					}
+					else
+					{
+						stack[stack_size++] = node.left_first + 1;
+						stack[stack_size++] = node.left_first;
+					}
+				}
+
+				rays.hit_t[ray] = closest;
+				rays.hit_object[ray] = closest_object;
+			}
+		}
+
+#if XPLOR_SIMD_X86
+		void IntersectBVHSSE(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays)
+		{
+			uint32_t stack[SceneBVH::MAX_DEPTH * 2];
+
+			for (size_t base = 0; base < rays.count; base += 4)
+			{
+				const size_t lanes = std::min<size_t>(4, rays.count - base);
+
+				// Unused lanes of the last packet get a negative range so they never hit
+				alignas(16) float origin[3][4]{};
+				alignas(16) float inv_direction[3][4]{};
+				alignas(16) float closest_lanes[4] = { -1.0f, -1.0f, -1.0f, -1.0f };
+				alignas(16) uint32_t object_lanes[4] = { RayHit::NO_HIT, RayHit::NO_HIT, RayHit::NO_HIT, RayHit::NO_HIT };
+				for (size_t lane = 0; lane < lanes; lane++)
+				{
+					origin[0][lane] = rays.origin_x[base + lane];
+					origin[1][lane] = rays.origin_y[base + lane];
+					origin[2][lane] = rays.origin_z[base + lane];
+					inv_direction[0][lane] = rays.inv_direction_x[base + lane];
+					inv_direction[1][lane] = rays.inv_direction_y[base + lane];
+					inv_direction[2][lane] = rays.inv_direction_z[base + lane];
+					closest_lanes[lane] = rays.hit_t[base + lane];
+					object_lanes[lane] = rays.hit_object[base + lane];
+				}
+
+				PacketSSE packet{
+					_mm_load_ps(origin[0]), _mm_load_ps(origin[1]), _mm_load_ps(origin[2]),
+					_mm_load_ps(inv_direction[0]), _mm_load_ps(inv_direction[1]), _mm_load_ps(inv_direction[2])
+				};
+				__m128 closest = _mm_load_ps(closest_lanes);
+				__m128i closest_object = _mm_load_si128(reinterpret_cast<const __m128i*>(object_lanes));
+
+				uint32_t stack_size = 0;
+				__m128 t_near;
+				if (_mm_movemask_ps(SlabSSE(nodes[0].min, nodes[0].max, packet, closest, t_near)))
+					stack[stack_size++] = 0;
+
+				while (stack_size > 0)
+				{
+					const BVHNode& node = nodes[stack[--stack_size]];
+
+					if (node.count > 0)
+					{
+						for (uint32_t i = node.left_first; i < node.left_first + node.count; i++)
+						{
+							__m128 hit = SlabSSE(item_boxes[i].min, item_boxes[i].max, packet, closest, t_near);
+							hit = _mm_and_ps(hit, _mm_cmplt_ps(t_near, closest));
+							if (!_mm_movemask_ps(hit))
+								continue;
+
+							closest = _mm_or_ps(_mm_and_ps(hit, t_near), _mm_andnot_ps(hit, closest));
+							__m128i hit_int = _mm_castps_si128(hit);
+							closest_object = _mm_or_si128(_mm_and_si128(hit_int, _mm_set1_epi32(static_cast<int>(items[i]))), _mm_andnot_si128(hit_int, closest_object));
+						}
+						continue;
+					}
+
+					// Test both children against the packet, visit the nearer one first
+					const uint32_t left = node.left_first;
+					__m128 near_left, near_right;
+					__m128 hit_left = SlabSSE(nodes[left].min, nodes[left].max, packet, closest, near_left);
+					__m128 hit_right = SlabSSE(nodes[left + 1].min, nodes[left + 1].max, packet, closest, near_right);
+					const bool any_left = _mm_movemask_ps(hit_left) != 0;
+					const bool any_right = _mm_movemask_ps(hit_right) != 0;
+
+					if (any_left && any_right)
+					{
+						if (NearestLaneSSE(near_left, hit_left) <= NearestLaneSSE(near_right, hit_right))
+						{
+							stack[stack_size++] = left + 1;
+							stack[stack_size++] = left;
+						}
+						else
+						{
+							stack[stack_size++] = left;
+							stack[stack_size++] = left + 1;
+						}
+					}
+					else if (any_left)
+					{
+						stack[stack_size++] = left;
+					}
+					else if (any_right)
+					{
+						stack[stack_size++] = left + 1;
+					}
+				}
+
+				_mm_store_ps(closest_lanes, closest);
+				_mm_store_si128(reinterpret_cast<__m128i*>(object_lanes), closest_object);
+				for (size_t lane = 0; lane < lanes; lane++)
+				{
+					rays.hit_t[base + lane] = closest_lanes[lane];
+					rays.hit_object[base + lane] = object_lanes[lane];
+				}
+			}
+		}
+#endif
+	}
+}
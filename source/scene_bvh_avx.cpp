@@ -0,0 +1,140 @@
+#include "scene_bvh.hpp"
+
+// Built with AVX code generation, nothing in here may run before GetSupportedSimdLevel reports AVX
+#if XPLOR_SIMD_X86
+#include <immintrin.h>
+
+namespace Xplor
+{
+	namespace
+	{
+		struct PacketAVX {
+			__m256 origin_x, origin_y, origin_z;
+			__m256 inv_x, inv_y, inv_z;
+		};
+
+		// Slab test of one box against eight rays, returns the lanes that hit closer than closest
+		inline __m256 SlabAVX(const float* box_min, const float* box_max, const PacketAVX& packet, __m256 closest, __m256& out_near)
+		{
+			// Empty box, see SlabScalar
+			if (box_min[0] > box_max[0])
+			{
+				out_near = closest;
+				return _mm256_setzero_ps();
+			}
+
+			__m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_min[0]), packet.origin_x), packet.inv_x);
+			__m256 t2x = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_max[0]), packet.origin_x), packet.inv_x);
+			__m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_min[1]), packet.origin_y), packet.inv_y);
+			__m256 t2y = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_max[1]), packet.origin_y), packet.inv_y);
+			__m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_min[2]), packet.origin_z), packet.inv_z);
+			__m256 t2z = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box_max[2]), packet.origin_z), packet.inv_z);
+
+			__m256 t_near = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t1x, t2x), _mm256_min_ps(t1y, t2y)), _mm256_max_ps(_mm256_min_ps(t1z, t2z), _mm256_setzero_ps()));
+			__m256 t_far = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t1x, t2x), _mm256_max_ps(t1y, t2y)), _mm256_min_ps(_mm256_max_ps(t1z, t2z), closest));
+
+			out_near = t_near;
+			return _mm256_cmp_ps(t_near, t_far, _CMP_LE_OQ);
+		}
+
+		// Smallest entry distance over the lanes in mask
+		inline float NearestLaneAVX(__m256 t_near, __m256 mask)
+		{
+			__m256 masked = _mm256_blendv_ps(_mm256_set1_ps(3.402823466e+38f), t_near, mask);
+			__m128 low = _mm_min_ps(_mm256_castps256_ps128(masked), _mm256_extractf128_ps(masked, 1));
+			low = _mm_min_ps(low, _mm_movehl_ps(low, low));
+			low = _mm_min_ss(low, _mm_shuffle_ps(low, low, 1));
+			return _mm_cvtss_f32(low);
+		}
+	}
+
+	namespace Detail
+	{
+		void IntersectBVHAVX(const BVHNode* nodes, const BVHBox* item_boxes, const uint32_t* items, const RayStreams& rays)
+		{
+			uint32_t stack[SceneBVH::MAX_DEPTH * 2];
+
+			size_t base = 0;
+			for (; base + 8 <= rays.count; base += 8)
+			{
+				PacketAVX packet{
+					_mm256_loadu_ps(rays.origin_x + base), _mm256_loadu_ps(rays.origin_y + base), _mm256_loadu_ps(rays.origin_z + base),
+					_mm256_loadu_ps(rays.inv_direction_x + base), _mm256_loadu_ps(rays.inv_direction_y + base), _mm256_loadu_ps(rays.inv_direction_z + base)
+				};
+				__m256 closest = _mm256_loadu_ps(rays.hit_t + base);
+				__m256 closest_object = _mm256_loadu_ps(reinterpret_cast<const float*>(rays.hit_object + base));
+
+				uint32_t stack_size = 0;
+				__m256 t_near;
+				if (_mm256_movemask_ps(SlabAVX(nodes[0].min, nodes[0].max, packet, closest, t_near)))
+					stack[stack_size++] = 0;
+
+				while (stack_size > 0)
+				{
+					const BVHNode& node = nodes[stack[--stack_size]];
+
+					if (node.count > 0)
+					{
+						for (uint32_t i = node.left_first; i < node.left_first + node.count; i++)
+						{
+							__m256 hit = SlabAVX(item_boxes[i].min, item_boxes[i].max, packet, closest, t_near);
+							hit = _mm256_and_ps(hit, _mm256_cmp_ps(t_near, closest, _CMP_LT_OQ));
+							if (!_mm256_movemask_ps(hit))
+								continue;
+
+							// Object indices ride along as float bit patterns, blendv only moves bits
+							closest = _mm256_blendv_ps(closest, t_near, hit);
+							closest_object = _mm256_blendv_ps(closest_object, _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(items[i]))), hit);
+						}
+						continue;
+					}
+
+					// Test both children against the packet, visit the nearer one first
+					const uint32_t left = node.left_first;
+					__m256 near_left, near_right;
+					__m256 hit_left = SlabAVX(nodes[left].min, nodes[left].max, packet, closest, near_left);
+					__m256 hit_right = SlabAVX(nodes[left + 1].min, nodes[left + 1].max, packet, closest, near_right);
+					const bool any_left = _mm256_movemask_ps(hit_left) != 0;
+					const bool any_right = _mm256_movemask_ps(hit_right) != 0;
+
+					if (any_left && any_right)
+					{
+						if (NearestLaneAVX(near_left, hit_left) <= NearestLaneAVX(near_right, hit_right))
+						{
+							stack[stack_size++] = left + 1;
+							stack[stack_size++] = left;
+						}
+						else
+						{
+							stack[stack_size++] = left;
+							stack[stack_size++] = left + 1;
+						}
+					}
+					else if (any_left)
+					{
+						stack[stack_size++] = left;
+					}
+					else if (any_right)
+					{
+						stack[stack_size++] = left + 1;
+					}
+				}
+
+				_mm256_storeu_ps(rays.hit_t + base, closest);
+				_mm256_storeu_ps(reinterpret_cast<float*>(rays.hit_object + base), closest_object);
+			}
+
+			// Fewer than eight rays left, the SSE kernel pads its last packet itself
+			if (base < rays.count)
+			{
+				RayStreams rest{
+					rays.origin_x + base, rays.origin_y + base, rays.origin_z + base,
+					rays.inv_direction_x + base, rays.inv_direction_y + base, rays.inv_direction_z + base,
+					rays.hit_object + base, rays.hit_t + base, rays.count - base
+				};
+				IntersectBVHSSE(nodes, item_boxes, items, rest);
+			}
+		}
+	}
+}
+#endif
@@ -1,8 +1,10 @@
 #include "shader.hpp"
+#include "log.hpp"
 
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cassert>
 
 Xplor::Shader::Shader(const char* vertexShaderPath, const char* fragmentShaderPath)
 {
@@ -10,11 +12,23 @@ Xplor::Shader::Shader(const char* vertexShaderPath, const char* fragmentShaderPa
 	m_fragmentPath = fragmentShaderPath;
 }
 
-uint32_t Xplor::Shader::getID()
+uint32_t Xplor::Shader::getID() const
 {
 	return m_shaderID;
 }
 
+GLint Xplor::Shader::getUniformLocation(StringId name) const
+{
+	auto iterator = m_uniformLocations.find(name);
+	if (iterator != m_uniformLocations.end())
+		return iterator->second;
+
+	assert(!name.getString().empty() && "Uniform name was never interned");
+	GLint location = glGetUniformLocation(m_shaderID, name.c_str());
+	m_uniformLocations[name] = location;
+	return location;
+}
+
 void Xplor::Shader::useProgram()
 {
 	glUseProgram(m_shaderID);
@@ -26,31 +40,47 @@ void Xplor::Shader::endProgram()
 }
 
 
-void Xplor::Shader::setUniform(const std::string& name, int value)
+void Xplor::Shader::setUniform(StringId name, int value) const
+{
+	glUniform1i(getUniformLocation(name), value);
+}
+
+void Xplor::Shader::setUniform(StringId name, glm::mat4 value) const
 {
-	glUniform1i(glGetUniformLocation(m_shaderID, name.c_str()), value);
-	m_uniformInts.push_back(std::make_tuple(name, value));
+	glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
 }
 
-void Xplor::Shader::setUniform(const std::string& name, glm::mat4 value) const
+void Xplor::Shader::setUniform(StringId name, bool value) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(m_shaderID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+	glUniform1i(getUniformLocation(name), static_cast<int>(value));
 }
 
-void Xplor::Shader::setUniform(const std::string& name, bool value) const
+void Xplor::Shader::setUniform(StringId name, float value) const
 {
-	glUniform1i(glGetUniformLocation(m_shaderID, name.c_str()), static_cast<int>(value));
+	glUniform1f(getUniformLocation(name), value);
 }
 
-void Xplor::Shader::setUniform(const std::string& name, float value) const
+void Xplor::Shader::bindUniformBlocks() const
 {
-	glUniform1i(glGetUniformLocation(m_shaderID, name.c_str()), static_cast<GLint>(value));
+	const std::pair<const char*, UniformBinding> blocks[] = {
+		{ "CameraBlock", UniformBinding::Camera },
+		{ "ObjectBlock", UniformBinding::Object },
+		{ "MaterialBlock", UniformBinding::Material }
+	};
+
+	for (const auto& block : blocks)
+	{
+		GLuint index = glGetUniformBlockIndex(m_shaderID, block.first);
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(m_shaderID, index, static_cast<GLuint>(block.second));
+	}
 }
 
 void Xplor::Shader::Delete()
 {
-	std::cout << "Shader Program Destroyed" << std::endl;
+	XPLOR_LOG_DEBUG(Shader, "Shader Program Destroyed");
 	glDeleteProgram(m_shaderID);
+	m_uniformLocations.clear();
 }
 
 GLuint Xplor::Shader::compileShader(int shaderType, const char *shaderSource) const
@@ -78,7 +108,7 @@ GLuint Xplor::Shader::compileShader(int shaderType, const char *shaderSource) co
 	if (!success)
 	{
 		glGetShaderInfoLog(id, 512, NULL, infoLog);
-		std::cout << "ERROR: SHADER_FRAGMENT Compilation FAILED\n" << infoLog << std::endl;
+		XPLOR_LOG_ERROR(Shader, "%s shader compilation failed\n%s", shaderType == GL_VERTEX_SHADER ? "Vertex" : "Fragment", infoLog);
 	}
 
 	return id;
@@ -1,4 +1,5 @@
 #include "shader_manager.hpp"
+#include "log.hpp"
 
 namespace Xplor
 {
@@ -17,13 +18,13 @@ namespace Xplor
 		return m_instance;
 	}*/
 
-	std::shared_ptr<Shader> ShaderManager::createShader(const std::string& name, const std::string& vertex_path, const std::string& fragment_path)
+	std::shared_ptr<Shader> ShaderManager::createShader(StringId name, const std::string& vertex_path, const std::string& fragment_path)
 	{
 		// Check if a shader with the name already exists
 		auto iterator = m_name_to_shader.find(name);
 		if (iterator != m_name_to_shader.end())
 		{
-			throw std::runtime_error("Shader with name '" + name + "' already exists.");
+			throw std::runtime_error("Shader with name '" + name.getString() + "' already exists.");
 		}
 
 		// Create the shader
@@ -34,7 +35,7 @@ namespace Xplor
 		return shader;
 	}
 
-	bool ShaderManager::findShader(const std::string& name, std::shared_ptr<Shader>& out_shader) const
+	bool ShaderManager::findShader(StringId name, std::shared_ptr<Shader>& out_shader) const
 	{
 		auto iterator = m_name_to_shader.find(name);
 		if (iterator != m_name_to_shader.end())
@@ -43,7 +44,7 @@ namespace Xplor
 			return true;
 		}
 		
-		std::cout << "No shader with name: '" << name << "' found." << std::endl;
+		XPLOR_LOG_WARNING(Shader, "No shader with name: '%s' (id %u) found.", name.c_str(), name.getHash());
 		return false;
 	}
 	
@@ -0,0 +1,89 @@
+#include "simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+#if XPLOR_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace Xplor
+{
+	namespace
+	{
+		SimdLevel DetectSimdLevel()
+		{
+#if XPLOR_SIMD_X86
+			uint32_t ecx = 0;
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			ecx = static_cast<uint32_t>(info[2]);
+#else
+			uint32_t eax, ebx, edx;
+			if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+				return SimdLevel::SSE;
+#endif
+			// AVX needs the CPU flag and the OS saving the ymm registers on context switches
+			const bool cpu_avx = (ecx & (1u << 28)) != 0;
+			const bool os_xsave = (ecx & (1u << 27)) != 0;
+			if (cpu_avx && os_xsave)
+			{
+#if defined(_MSC_VER)
+				const uint64_t xcr0 = _xgetbv(0);
+#else
+				uint32_t xcr0_low, xcr0_high;
+				__asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+				const uint64_t xcr0 = (static_cast<uint64_t>(xcr0_high) << 32) | xcr0_low;
+#endif
+				if ((xcr0 & 0x6) == 0x6)
+					return SimdLevel::AVX;
+			}
+			// SSE2 is part of every x86-64 CPU
+			return SimdLevel::SSE;
+#else
+			return SimdLevel::Scalar;
+#endif
+		}
+
+		const SimdLevel s_supported_level = DetectSimdLevel();
+		std::atomic<SimdLevel> s_level{ s_supported_level };
+	}
+
+	SimdLevel GetSupportedSimdLevel()
+	{
+		return s_supported_level;
+	}
+
+	SimdLevel GetSimdLevel()
+	{
+		return s_level.load(std::memory_order_relaxed);
+	}
+
+	void SetSimdLevel(SimdLevel level)
+	{
+		s_level.store(std::min(level, s_supported_level));
+	}
+
+	const char* GetSimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::Scalar:
+			return "Scalar";
+		case SimdLevel::SSE:
+			return "SSE";
+		case SimdLevel::AVX:
+			return "AVX";
+		default:
+			assert(false && "Undefined enum value in switch statement");
+			return "";
+		}
+	}
+}
@@ -0,0 +1,157 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace Xplor
+{
+	namespace
+	{
+		constexpr const char* STAT_NAMES[] = {
+			"Draw calls", "Triangles", "State changes", "Buffer bytes", "Textures bound",
+			"Objects updated", "Objects culled", "Objects visible", "Heap allocations"
+		};
+		static_assert(sizeof(STAT_NAMES) / sizeof(STAT_NAMES[0]) == Stats::STAT_COUNT, "Every stat needs a name");
+
+		// Spikes are only judged once the median means something
+		constexpr uint32_t MIN_FRAMES_FOR_SPIKES = 60;
+	}
+
+	struct Stats::State {
+		std::mutex mutex; // Guards the thread list, the counters themselves are atomics
+		std::vector<Counters*> threads;
+		std::array<uint64_t, STAT_COUNT> previous_totals{};
+		std::array<uint64_t, STAT_COUNT> frame_values{};
+		StatCounts packet{}; // Counts of the packets retired since the last endFrame
+
+		FrameTimes frame_times{};
+		FrameTimes scratch{};
+		uint32_t head{}; // Next entry to write, also the oldest one once the history is full
+		uint32_t count{};
+		uint64_t frame{};
+
+		std::array<Spike, MAX_SPIKES> spikes{};
+		uint32_t spike_count{};
+	};
+
+	// Never destroyed, threads may still count while statics are torn down
+	Stats::State& Stats::getState()
+	{
+		static State* state = new State();
+		return *state;
+	}
+
+	Stats::Counters* Stats::registerThread()
+	{
+		State& state = getState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		// Kept after the thread exits, its totals still count
+		state.threads.push_back(new Counters());
+		return state.threads.back();
+	}
+
+	void Stats::endFrame(float frame_ms)
+	{
+		State& state = getState();
+
+		//--- Counters, totals only grow so the frame's share is the difference to the last merge
+		std::array<uint64_t, STAT_COUNT> totals{};
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			for (const Counters* counters : state.threads)
+			{
+				for (uint32_t i = 0; i < STAT_COUNT; i++)
+				{
+					totals[i] += counters->values[i].load(std::memory_order_relaxed);
+				}
+			}
+		}
+		for (uint32_t i = 0; i < STAT_COUNT; i++)
+		{
+			state.frame_values[i] = totals[i] - state.previous_totals[i] + state.packet.values[i];
+		}
+		state.previous_totals = totals;
+		state.packet = {};
+
+		//--- Frame time
+		state.frame_times[state.head] = frame_ms;
+		state.head = (state.head + 1) % HISTORY_SIZE;
+		state.count = std::min(state.count + 1, HISTORY_SIZE);
+		state.frame++;
+
+		if (state.count >= MIN_FRAMES_FOR_SPIKES && frame_ms > SPIKE_FACTOR * getPercentile(0.5f))
+		{
+			if (state.spike_count == MAX_SPIKES)
+			{
+				std::move(state.spikes.begin() + 1, state.spikes.end(), state.spikes.begin());
+				state.spike_count--;
+			}
+			state.spikes[state.spike_count++] = { state.frame, frame_ms };
+		}
+	}
+
+	void Stats::addPacket(const StatCounts& counts)
+	{
+		State& state = getState();
+		for (uint32_t i = 0; i < STAT_COUNT; i++)
+		{
+			state.packet.values[i] += counts.values[i];
+		}
+	}
+
+	uint64_t Stats::get(Stat stat)
+	{
+		return getState().frame_values[static_cast<uint32_t>(stat)];
+	}
+
+	const char* Stats::GetStatName(Stat stat)
+	{
+		return STAT_NAMES[static_cast<uint32_t>(stat)];
+	}
+
+	const Stats::FrameTimes& Stats::getFrameTimes(uint32_t& out_offset)
+	{
+		State& state = getState();
+		out_offset = state.count == HISTORY_SIZE ? state.head : 0;
+		return state.frame_times;
+	}
+
+	uint32_t Stats::getFrameTimeCount()
+	{
+		return getState().count;
+	}
+
+	float Stats::getPercentile(float fraction)
+	{
+		State& state = getState();
+		if (state.count == 0)
+			return 0.0f;
+
+		auto begin = state.scratch.begin();
+		auto end = begin + state.count;
+		std::copy(state.frame_times.begin(), state.frame_times.begin() + state.count, begin);
+
+		const uint32_t index = std::min(static_cast<uint32_t>(fraction * static_cast<float>(state.count)), state.count - 1);
+		std::nth_element(begin, begin + index, end);
+		return state.scratch[index];
+	}
+
+	float Stats::getMaxFrameTime()
+	{
+		State& state = getState();
+		return state.count == 0 ? 0.0f : *std::max_element(state.frame_times.begin(), state.frame_times.begin() + state.count);
+	}
+
+	const Stats::Spike* Stats::getSpikes(uint32_t& out_count)
+	{
+		State& state = getState();
+		out_count = state.spike_count;
+		return state.spikes.data();
+	}
+
+	uint64_t Stats::getFrameIndex()
+	{
+		return getState().frame;
+	}
+}
@@ -0,0 +1,178 @@
+#include "stream_buffer.hpp"
+
+#include <cstring>
+
+namespace Xplor
+{
+	StreamBuffer::~StreamBuffer()
+	{
+		destroy();
+	}
+
+	void StreamBuffer::init(GLenum target, size_t frame_size, size_t region_alignment)
+	{
+		m_target = target;
+		m_region_alignment = region_alignment;
+		m_frame_size = (frame_size + m_region_alignment - 1) / m_region_alignment * m_region_alignment;
+		m_persistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+		create();
+	}
+
+	void StreamBuffer::create()
+	{
+		const size_t total_size = m_frame_size * FRAME_COUNT;
+
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(m_target, m_buffer);
+
+		if (m_persistent)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(m_target, total_size, nullptr, flags);
+			m_mapped = static_cast<uint8_t*>(glMapBufferRange(m_target, 0, total_size, flags));
+		}
+		else
+		{
+			glBufferData(m_target, total_size, nullptr, GL_STREAM_DRAW);
+			m_staging.reserve(m_frame_size);
+		}
+
+		glBindBuffer(m_target, 0);
+	}
+
+	void StreamBuffer::destroy()
+	{
+		for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+		{
+			if (m_fences[frame])
+			{
+				glDeleteSync(m_fences[frame]);
+				m_fences[frame] = nullptr;
+			}
+		}
+
+		if (m_buffer)
+		{
+			if (m_mapped)
+			{
+				glBindBuffer(m_target, m_buffer);
+				glUnmapBuffer(m_target);
+				glBindBuffer(m_target, 0);
+				m_mapped = nullptr;
+			}
+			glDeleteBuffers(1, &m_buffer);
+			m_buffer = 0;
+		}
+	}
+
+	void StreamBuffer::grow(size_t frame_size)
+	{
+		frame_size = (frame_size + m_region_alignment - 1) / m_region_alignment * m_region_alignment;
+
+		// Every region may still be read by the GPU
+		for (uint32_t frame = 0; frame < FRAME_COUNT; frame++)
+		{
+			waitForFence(frame);
+		}
+
+		if (m_persistent)
+		{
+			// Immutable storage can not be resized, keep what was written this frame and recreate it
+			const uint8_t* region = m_mapped + getRegionOffset();
+			std::vector<uint8_t> written(region, region + m_cursor);
+			destroy();
+			m_frame_size = frame_size;
+			create();
+			std::memcpy(m_mapped + getRegionOffset(), written.data(), written.size());
+		}
+		else
+		{
+			// Orphan the old storage, the written data is still in the staging copy
+			m_frame_size = frame_size;
+			glBindBuffer(m_target, m_buffer);
+			glBufferData(m_target, m_frame_size * FRAME_COUNT, nullptr, GL_STREAM_DRAW);
+			glBindBuffer(m_target, 0);
+		}
+	}
+
+	void StreamBuffer::waitForFence(uint32_t frame)
+	{
+		GLsync& fence = m_fences[frame];
+		if (!fence)
+			return;
+
+		// Flush on the first wait so the fence is guaranteed to signal
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		GLuint64 timeout = 0;
+		while (true)
+		{
+			GLenum result = glClientWaitSync(fence, flags, timeout);
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+				break;
+			flags = 0;
+			timeout = 1000000; // 1ms
+		}
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	void StreamBuffer::beginFrame()
+	{
+		m_frame = (m_frame + 1) % FRAME_COUNT;
+		waitForFence(m_frame);
+		m_cursor = 0;
+		m_staging.clear();
+	}
+
+	size_t StreamBuffer::allocate(size_t size, size_t alignment)
+	{
+		size_t offset = (m_cursor + alignment - 1) / alignment * alignment;
+		if (offset + size > m_frame_size)
+			grow((offset + size) * 2);
+
+		m_cursor = offset + size;
+		if (!m_persistent)
+			m_staging.resize(m_cursor);
+
+		return offset;
+	}
+
+	void* StreamBuffer::getPointer(size_t offset)
+	{
+		if (m_persistent)
+			return m_mapped + getRegionOffset() + offset;
+
+		return m_staging.data() + offset;
+	}
+
+	size_t StreamBuffer::write(const void* data, size_t size, size_t alignment)
+	{
+		size_t offset = allocate(size, alignment);
+		std::memcpy(getPointer(offset), data, size);
+		return offset;
+	}
+
+	void StreamBuffer::flush()
+	{
+		// Coherent persistent mappings are visible to the GPU without any extra work
+		if (m_persistent || m_cursor == 0)
+			return;
+
+		glBindBuffer(m_target, m_buffer);
+		// The fence waited on in beginFrame guarantees the GPU is done with this region
+		void* destination = glMapBufferRange(m_target, getRegionOffset(), m_cursor,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (destination)
+		{
+			std::memcpy(destination, m_staging.data(), m_cursor);
+			glUnmapBuffer(m_target);
+		}
+		glBindBuffer(m_target, 0);
+	}
+
+	void StreamBuffer::endFrame()
+	{
+		m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+}
@@ -0,0 +1,79 @@
+#include "string_id.hpp"
+#include "log.hpp"
+
+#include <cassert>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace Xplor
+{
+	namespace
+	{
+		struct InternTable {
+			std::shared_mutex mutex;
+			std::unordered_map<uint32_t, std::string> strings;
+		};
+
+		// Never destroyed, names held by static objects stay readable during shutdown
+		InternTable& GetInternTable()
+		{
+			static InternTable* table = new InternTable();
+			return *table;
+		}
+
+		// Release builds would otherwise hand out the other name's id and resolve to its resources
+		void ReportCollision(std::string_view text, const std::string& interned, uint32_t hash)
+		{
+			XPLOR_LOG_ERROR(Core, "String id collision, \"%.*s\" and \"%s\" both hash to 0x%08x. The second name is not interned.",
+				static_cast<int>(text.size()), text.data(), interned.c_str(), hash);
+			assert(false && "Two names hash to the same string id");
+		}
+	}
+
+	StringId::StringId(std::string_view text)
+		: m_hash(text.empty() ? 0 : HashString(text))
+	{
+		if (empty())
+			return;
+
+		InternTable& table = GetInternTable();
+
+		// Names are interned once and looked up many times, most calls only need the shared lock
+		{
+			std::shared_lock<std::shared_mutex> lock(table.mutex);
+			auto iterator = table.strings.find(m_hash);
+			if (iterator != table.strings.end())
+			{
+				if (iterator->second != text)
+				{
+					ReportCollision(text, iterator->second, m_hash);
+					m_hash = 0;
+				}
+				return;
+			}
+		}
+
+		std::unique_lock<std::shared_mutex> lock(table.mutex);
+		auto iterator = table.strings.try_emplace(m_hash, text).first;
+		if (iterator->second != text)
+		{
+			ReportCollision(text, iterator->second, m_hash);
+			m_hash = 0;
+		}
+	}
+
+	const std::string& StringId::getString() const
+	{
+		static const std::string EMPTY;
+		if (empty())
+			return EMPTY;
+
+		InternTable& table = GetInternTable();
+		std::shared_lock<std::shared_mutex> lock(table.mutex);
+		auto iterator = table.strings.find(m_hash);
+
+		// Entries are never erased so the reference stays valid after the lock is released
+		return iterator != table.strings.end() ? iterator->second : EMPTY;
+	}
+}
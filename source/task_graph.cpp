@@ -0,0 +1,142 @@
+#include "task_graph.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+namespace Xplor
+{
+	TaskGraph::TaskId TaskGraph::addTask(const std::string& name, std::function<void()> function, const std::vector<TaskId>& dependencies, bool main_thread)
+	{
+		TaskId id = static_cast<TaskId>(m_tasks.size());
+		m_tasks.push_back({ name, std::move(function), {}, static_cast<uint32_t>(dependencies.size()), main_thread });
+		m_timings.push_back({});
+		m_last_timings.push_back({});
+
+		for (TaskId dependency : dependencies)
+		{
+			assert(dependency < id && "Task dependencies have to be declared first");
+			m_tasks[dependency].successors.push_back(id);
+		}
+
+		m_pending_dependencies.reset(new std::atomic<uint32_t>[m_tasks.size()]);
+		return id;
+	}
+
+	void TaskGraph::execute()
+	{
+		if (m_tasks.empty())
+			return;
+
+		m_start = std::chrono::steady_clock::now();
+		m_remaining.store(static_cast<uint32_t>(m_tasks.size()));
+		for (TaskId id = 0; id < m_tasks.size(); id++)
+		{
+			m_pending_dependencies[id].store(m_tasks[id].dependency_count);
+		}
+
+		for (TaskId id = 0; id < m_tasks.size(); id++)
+		{
+			if (m_tasks[id].dependency_count == 0)
+				schedule(id);
+		}
+
+		// Run main thread stages as they become ready. In between, only help with the jobs the
+		// worker stages fanned out: a whole stage taken from the queue could block or run long
+		// enough to hold up the main thread stages becoming ready meanwhile.
+		auto job_system = JobSystem::getInstance();
+		while (m_remaining.load(std::memory_order_acquire) != 0)
+		{
+			TaskId main_task = 0;
+			bool has_main_task = false;
+			{
+				std::lock_guard<std::mutex> lock(m_main_mutex);
+				if (!m_main_queue.empty())
+				{
+					main_task = m_main_queue.back();
+					m_main_queue.pop_back();
+					has_main_task = true;
+				}
+			}
+
+			if (has_main_task)
+				runTask(main_task);
+			else if (!job_system->runPendingJob(this))
+				std::this_thread::yield();
+		}
+
+		m_execution_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+		computeCriticalPath();
+		m_last_timings = m_timings;
+	}
+
+	void TaskGraph::schedule(TaskId task)
+	{
+		if (m_tasks[task].main_thread)
+		{
+			std::lock_guard<std::mutex> lock(m_main_mutex);
+			m_main_queue.push_back(task);
+			return;
+		}
+
+		// Stages themselves are not part of the group, only the jobs they queue
+		JobGroupScope group(nullptr);
+		JobSystem::getInstance()->run([this, task]() { runTask(task); });
+	}
+
+	void TaskGraph::runTask(TaskId task)
+	{
+		auto start = std::chrono::steady_clock::now();
+		{
+			XPLOR_PROFILE_SCOPE(m_tasks[task].name.c_str());
+			JobGroupScope group(m_tasks[task].main_thread ? nullptr : this);
+			m_tasks[task].function();
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		m_timings[task].start_ms = std::chrono::duration<float, std::milli>(start - m_start).count();
+		m_timings[task].end_ms = std::chrono::duration<float, std::milli>(end - m_start).count();
+
+		for (TaskId successor : m_tasks[task].successors)
+		{
+			if (m_pending_dependencies[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)
+				schedule(successor);
+		}
+
+		m_remaining.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+	void TaskGraph::computeCriticalPath()
+	{
+		// Tasks are stored in a valid topological order since dependencies are declared first
+		const size_t count = m_tasks.size();
+		m_path_ms.assign(count, 0.0f);
+		m_previous.assign(count, -1);
+		std::vector<float>& path_ms = m_path_ms;
+		std::vector<int>& previous = m_previous;
+
+		for (TaskId id = 0; id < count; id++)
+		{
+			path_ms[id] += m_timings[id].end_ms - m_timings[id].start_ms;
+			m_timings[id].on_critical_path = false;
+
+			for (TaskId successor : m_tasks[id].successors)
+			{
+				if (path_ms[id] > path_ms[successor])
+				{
+					path_ms[successor] = path_ms[id];
+					previous[successor] = static_cast<int>(id);
+				}
+			}
+		}
+
+		// path_ms of a successor holds the longest incoming chain until its own duration is added
+		int last = static_cast<int>(std::max_element(path_ms.begin(), path_ms.end()) - path_ms.begin());
+		m_critical_path_ms = path_ms[last];
+		for (int id = last; id != -1; id = previous[id])
+		{
+			m_timings[id].on_critical_path = true;
+		}
+	}
+}
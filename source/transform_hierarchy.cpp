@@ -0,0 +1,272 @@
+#include "transform_hierarchy.hpp"
+
+#include <cassert>
+
+namespace Xplor
+{
+	TransformHierarchy::TransformId TransformHierarchy::create(uint32_t user_data, const glm::mat4& local, TransformId parent)
+	{
+		TransformId id;
+		if (!m_free_ids.empty())
+		{
+			id = m_free_ids.back();
+			m_free_ids.pop_back();
+		}
+		else
+		{
+			id = static_cast<TransformId>(m_id_to_slot.size());
+			m_id_to_slot.push_back(NONE);
+			m_parent_ids.push_back(INVALID_TRANSFORM);
+			m_first_child.push_back(INVALID_TRANSFORM);
+			m_next_sibling.push_back(INVALID_TRANSFORM);
+			m_previous_sibling.push_back(INVALID_TRANSFORM);
+		}
+
+		// Appending keeps the order valid, the parent already has a lower slot
+		NodeState state;
+		state.parent = parent != INVALID_TRANSFORM ? m_id_to_slot[parent] : NONE;
+
+		Node node;
+		node.id = id;
+		node.user_data = user_data;
+		node.local = local;
+		node.world = state.parent != NONE ? m_nodes[state.parent].world * local : local;
+		node.previous_translation = glm::vec3(node.world[3]);
+
+		m_id_to_slot[id] = static_cast<uint32_t>(m_nodes.size());
+		link(id, parent);
+		m_nodes.push_back(node);
+		m_states.push_back(state);
+		return id;
+	}
+
+	void TransformHierarchy::destroy(TransformId id)
+	{
+		assert(id < m_id_to_slot.size() && m_id_to_slot[id] != NONE && "Destroying an unknown transform");
+
+		// The children become roots where they are, a root may sit anywhere in the order
+		TransformId child = m_first_child[id];
+		while (child != INVALID_TRANSFORM)
+		{
+			const TransformId next = m_next_sibling[child];
+			m_parent_ids[child] = INVALID_TRANSFORM;
+			m_next_sibling[child] = INVALID_TRANSFORM;
+			m_previous_sibling[child] = INVALID_TRANSFORM;
+
+			NodeState& state = m_states[m_id_to_slot[child]];
+			state.parent = NONE;
+			state.local_dirty = 1;
+			child = next;
+		}
+		m_first_child[id] = INVALID_TRANSFORM;
+		unlink(id);
+
+		// Removing the slot now would shift or swap the others, the next update compacts every
+		// destroyed slot in one pass instead
+		m_states[m_id_to_slot[id]].removed = 1;
+		m_removed_count++;
+
+		m_id_to_slot[id] = NONE;
+		m_free_ids.push_back(id);
+	}
+
+	void TransformHierarchy::setParent(TransformId id, TransformId parent)
+	{
+		for (TransformId ancestor = parent; ancestor != INVALID_TRANSFORM; ancestor = m_parent_ids[ancestor])
+		{
+			if (ancestor == id)
+			{
+				assert(false && "Parenting a transform to its own descendant");
+				return;
+			}
+		}
+
+		if (m_parent_ids[id] == parent)
+			return;
+
+		unlink(id);
+		link(id, parent);
+
+		// The order still holds if the new parent already comes first, otherwise it is rebuilt
+		// on the next update
+		const uint32_t slot = m_id_to_slot[id];
+		const uint32_t parent_slot = parent != INVALID_TRANSFORM ? m_id_to_slot[parent] : NONE;
+		if (parent_slot == NONE || parent_slot < slot)
+			m_states[slot].parent = parent_slot;
+		else
+			m_order_dirty = true;
+		m_states[slot].local_dirty = 1;
+	}
+
+	void TransformHierarchy::link(TransformId id, TransformId parent)
+	{
+		m_parent_ids[id] = parent;
+		if (parent == INVALID_TRANSFORM)
+			return;
+
+		const TransformId first = m_first_child[parent];
+		m_next_sibling[id] = first;
+		if (first != INVALID_TRANSFORM)
+			m_previous_sibling[first] = id;
+		m_first_child[parent] = id;
+	}
+
+	void TransformHierarchy::unlink(TransformId id)
+	{
+		const TransformId parent = m_parent_ids[id];
+		if (parent == INVALID_TRANSFORM)
+			return;
+
+		const TransformId previous = m_previous_sibling[id];
+		const TransformId next = m_next_sibling[id];
+		if (previous != INVALID_TRANSFORM)
+			m_next_sibling[previous] = next;
+		else
+			m_first_child[parent] = next;
+		if (next != INVALID_TRANSFORM)
+			m_previous_sibling[next] = previous;
+
+		m_parent_ids[id] = INVALID_TRANSFORM;
+		m_next_sibling[id] = INVALID_TRANSFORM;
+		m_previous_sibling[id] = INVALID_TRANSFORM;
+	}
+
+	TransformHierarchy::TransformId TransformHierarchy::getParent(TransformId id) const
+	{
+		return m_parent_ids[id];
+	}
+
+	void TransformHierarchy::update()
+	{
+		if (m_removed_count > 0)
+			compact();
+		if (m_order_dirty)
+			rebuildOrder();
+
+		m_pass++;
+		m_changed.clear();
+
+		const uint32_t count = static_cast<uint32_t>(m_nodes.size());
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			NodeState& state = m_states[slot];
+			const bool parent_changed = state.parent != NONE && m_states[state.parent].changed_pass == m_pass;
+			if (!state.local_dirty && !parent_changed)
+				continue;
+
+			Node& node = m_nodes[slot];
+			const glm::vec3 translation(node.world[3]);
+			node.world = state.parent != NONE ? m_nodes[state.parent].world * node.local : node.local;
+			node.previous_translation = state.snap ? glm::vec3(node.world[3]) : translation;
+			state.changed_pass = m_pass;
+			state.local_dirty = 0;
+			state.snap = 0;
+			m_changed.push_back(node.id);
+		}
+	}
+
+	glm::mat4 TransformHierarchy::getWorld(TransformId id, float alpha) const
+	{
+		const uint32_t slot = m_id_to_slot[id];
+		const Node& node = m_nodes[slot];
+		if (m_states[slot].changed_pass != m_pass || alpha >= 1.0f)
+			return node.world;
+
+		glm::mat4 world = node.world;
+		world[3] = glm::vec4(glm::mix(node.previous_translation, glm::vec3(node.world[3]), alpha), 1.0f);
+		return world;
+	}
+
+	glm::mat4 TransformHierarchy::evaluateWorld(TransformId id) const
+	{
+		const Node& node = m_nodes[m_id_to_slot[id]];
+		const TransformId parent = m_parent_ids[id];
+		return parent != INVALID_TRANSFORM ? m_nodes[m_id_to_slot[parent]].world * node.local : node.local;
+	}
+
+	void TransformHierarchy::clear()
+	{
+		m_nodes.clear();
+		m_states.clear();
+		m_parent_ids.clear();
+		m_id_to_slot.clear();
+		m_first_child.clear();
+		m_next_sibling.clear();
+		m_previous_sibling.clear();
+		m_free_ids.clear();
+		m_changed.clear();
+		m_removed_count = 0;
+		m_order_dirty = false;
+	}
+
+	void TransformHierarchy::compact()
+	{
+		// Stable, so parents stay in front of their children and the order remains valid
+		const uint32_t count = static_cast<uint32_t>(m_nodes.size());
+		uint32_t write = 0;
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_states[slot].removed)
+				continue;
+
+			if (write != slot)
+			{
+				m_nodes[write] = m_nodes[slot];
+				m_states[write] = m_states[slot];
+			}
+
+			const TransformId id = m_nodes[write].id;
+			m_id_to_slot[id] = write;
+
+			// A valid order puts the parent at a lower slot, so it was already moved. A stale one
+			// is rebuilt right after anyway.
+			const TransformId parent = m_parent_ids[id];
+			if (!m_order_dirty)
+				m_states[write].parent = parent != INVALID_TRANSFORM ? m_id_to_slot[parent] : NONE;
+			write++;
+		}
+
+		m_nodes.resize(write);
+		m_states.resize(write);
+		m_removed_count = 0;
+	}
+
+	void TransformHierarchy::rebuildOrder()
+	{
+		// Breadth first from the roots along the child lists, the output doubles as the queue
+		const uint32_t count = static_cast<uint32_t>(m_nodes.size());
+		m_sorted.clear();
+		m_sorted_states.clear();
+		m_sorted.reserve(count);
+		m_sorted_states.reserve(count);
+
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_parent_ids[m_nodes[slot].id] != INVALID_TRANSFORM)
+				continue;
+			m_sorted.push_back(m_nodes[slot]);
+			m_sorted_states.push_back(m_states[slot]);
+			m_sorted_states.back().parent = NONE;
+		}
+
+		for (uint32_t i = 0; i < m_sorted.size(); i++)
+		{
+			for (TransformId child = m_first_child[m_sorted[i].id]; child != INVALID_TRANSFORM; child = m_next_sibling[child])
+			{
+				const uint32_t slot = m_id_to_slot[child];
+				m_sorted.push_back(m_nodes[slot]);
+				m_sorted_states.push_back(m_states[slot]);
+				m_sorted_states.back().parent = i;
+			}
+		}
+
+		assert(m_sorted.size() == count && "Transform hierarchy contains a cycle");
+		m_nodes.swap(m_sorted);
+		m_states.swap(m_sorted_states);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			m_id_to_slot[m_nodes[slot].id] = slot;
+		}
+		m_order_dirty = false;
+	}
+}
@@ -0,0 +1,15 @@
+#include "uniform_ring.hpp"
+
+namespace Xplor
+{
+	void UniformRing::init(size_t frame_size)
+	{
+		GLint alignment = 0;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		if (alignment > 0)
+			m_alignment = static_cast<size_t>(alignment);
+
+		// Region starts have to respect the alignment as well
+		m_stream.init(GL_UNIFORM_BUFFER, frame_size, m_alignment);
+	}
+}
@@ -1,7 +1,15 @@
 #include "window_manager.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include "engine_manager.hpp"
+#include "allocation_counter.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
+#include "stats.hpp"
 #include <iostream>
+#include <cfloat>
+#include <cstdio>
+#include <array>
+#include <algorithm>
 
 //--------- GLFW Function Prototypes Impls 
 //------------------------------------------------------------------------------------------
@@ -11,8 +19,8 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	// Set the drawing location to the bottom left of the window and set the rendering area
 	// This actually performs the transformation of 2D coordinates to screen locations
-	glViewport(0, 0, width, height);
-
+	// The viewport itself is set by the renderer every frame from the framebuffer size, this
+	// callback may run while the OpenGL context is owned by the render thread
 
 	float aspect_ratio = static_cast<float>(width) / static_cast<float>(height);
 
@@ -34,7 +42,7 @@ void WindowManager::Init(int window_width, int window_height, bool fullscreen)
 	//--- Start glfw up
 	if (!glfwInit())
 	{
-		std::cout << "Failed to initialize GLFW" << std::endl;
+		XPLOR_LOG_ERROR(Core, "Failed to initialize GLFW");
 		return;
 	}
 
@@ -55,7 +63,7 @@ void WindowManager::Init(int window_width, int window_height, bool fullscreen)
 	// Cleanup GLFW if the window creation fails
 	if (!m_window)
 	{
-		std::cout << "Failed to create a GLFW window" << std::endl;
+		XPLOR_LOG_ERROR(Core, "Failed to create a GLFW window");
 		glfwTerminate();
 		return;
 	}
@@ -70,7 +78,7 @@ void WindowManager::Init(int window_width, int window_height, bool fullscreen)
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
 		// GLAD needs to have a context to check the OpenGL version against
-		std::cout << "Failed to initialize GLAD" << std::endl;
+		XPLOR_LOG_ERROR(Core, "Failed to initialize GLAD");
 		return;
 	}
 
@@ -127,11 +135,11 @@ void WindowManager::PrintHardwareInfo()
 	auto vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
 	auto openglVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
 	auto renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
-	std::cout << "Vendor: " << vendor << "\nRenderer: " << renderer << std::endl;
+	XPLOR_LOG_INFO(Render, "Vendor: %s, Renderer: %s", vendor, renderer);
 	int major, minor;
 	glGetIntegerv(GL_MAJOR_VERSION, &major);
 	glGetIntegerv(GL_MINOR_VERSION, &minor);
-	std::cout << "OpenGL Version: " << major << "." << minor << std::endl;
+	XPLOR_LOG_INFO(Render, "OpenGL Version: %d.%d", major, minor);
 }
 
 
@@ -290,7 +298,7 @@ void WindowManager::ProcessInputs(glm::vec3& out_camera_pos, const glm::vec3 cam
 {
 	if (!m_window)
 	{
-		std::cout << "Error: Window not created" << std::endl;
+		XPLOR_LOG_ERROR(Input, "Window not created");
 		return;
 	}
 
@@ -299,6 +307,13 @@ void WindowManager::ProcessInputs(glm::vec3& out_camera_pos, const glm::vec3 cam
 		// Enable the close window flag
 		glfwSetWindowShouldClose(m_window, true);
 	}
+#ifdef XPLOR_PROFILE
+	// Trace the next frames, the file is written once the last one finished
+	const bool capture_key_down = glfwGetKey(m_window, GLFW_KEY_F9) == GLFW_PRESS;
+	if (capture_key_down && !m_capture_key_down && Xplor::Profiler::beginCapture())
+		XPLOR_LOG_INFO(Core, "Capturing %u frames", Xplor::Profiler::DEFAULT_CAPTURE_FRAMES);
+	m_capture_key_down = capture_key_down;
+#endif
 	if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS)
 	{
 		out_camera_pos += camera_speed * camera_front;
@@ -321,30 +336,151 @@ void WindowManager::ProcessInputs(glm::vec3& out_camera_pos, const glm::vec3 cam
 //----------- IMGUI
 //------------------------------------------------------------------------------------------
 
+// The OpenGL backend's NewFrame is called by the renderer on the thread owning the context
 void WindowManager::NewImguiFrame()
 {
-	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
 }
 
-void WindowManager::CreateEditorUI()
+// What the last frame did and how frame times are spread, the first place to look when a scene gets slow
+static void CreatePerformancePanel()
 {
-	static float f = 0.0f;
-	static int counter = 0;
+	if (!ImGui::CollapsingHeader("Performance", ImGuiTreeNodeFlags_DefaultOpen))
+		return;
 
+	const uint32_t frame_count = Xplor::Stats::getFrameTimeCount();
+	const float max_ms = Xplor::Stats::getMaxFrameTime();
+	ImGui::Text("Frame p50 %.2f ms, p99 %.2f ms, max %.2f ms over %u frames", Xplor::Stats::getPercentile(0.5f),
+		Xplor::Stats::getPercentile(0.99f), max_ms, frame_count);
+
+	uint32_t offset = 0;
+	const Xplor::Stats::FrameTimes& frame_times = Xplor::Stats::getFrameTimes(offset);
+	ImGui::PlotLines("Frame ms", frame_times.data(), static_cast<int>(frame_count), static_cast<int>(offset),
+		nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
+
+	// Distribution of the recorded frame times from 0 to the slowest one
+	constexpr int BUCKETS = 40;
+	std::array<float, BUCKETS> histogram{};
+	const float range_ms = std::max(max_ms, 1.0f);
+	for (uint32_t i = 0; i < frame_count; i++)
+	{
+		histogram[std::min(static_cast<int>(frame_times[i] / range_ms * BUCKETS), BUCKETS - 1)] += 1.0f;
+	}
+	char overlay[32];
+	std::snprintf(overlay, sizeof(overlay), "0 - %.1f ms", range_ms);
+	ImGui::PlotHistogram("Distribution", histogram.data(), BUCKETS, 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 60.0f));
 
+	for (uint32_t stat = 0; stat < Xplor::Stats::STAT_COUNT; stat++)
+	{
+		ImGui::Text("%-18s %llu", Xplor::Stats::GetStatName(static_cast<Xplor::Stat>(stat)),
+			static_cast<unsigned long long>(Xplor::Stats::get(static_cast<Xplor::Stat>(stat))));
+	}
+
+	uint32_t spike_count = 0;
+	const Xplor::Stats::Spike* spikes = Xplor::Stats::getSpikes(spike_count);
+	ImGui::Text("Spikes over %.0fx the median: %u", Xplor::Stats::SPIKE_FACTOR, spike_count);
+	for (uint32_t i = spike_count; i-- > 0;)
+	{
+		ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.3f, 1.0f), "  frame %llu: %.2f ms, %llu frames ago",
+			static_cast<unsigned long long>(spikes[i].frame), spikes[i].ms,
+			static_cast<unsigned long long>(Xplor::Stats::getFrameIndex() - spikes[i].frame));
+	}
+}
+
+void WindowManager::CreateEditorUI()
+{
 	ImGui::Begin("Editor"); // Create a window and append into it.
 
-	ImGui::Text("UI Text.");
-	ImGui::SliderFloat("float", &f, 0.0f, 1.0f);
 	ImGui::ColorEdit3("clear color", (float*)&m_clear_color);
-
-	if (ImGui::Button("Button"))   // Buttons return true when clicked (most widgets return true when edited/activated)
-		counter++;
-	ImGui::SameLine();
-	ImGui::Text("counter = %d", counter);
 	auto io = ImGui::GetIO();
 	ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+	CreatePerformancePanel();
+
+	const Xplor::ActivitySet& activity = Xplor::EngineManager::GetInstance()->getActivitySet();
+	ImGui::Text("Simulation: %zu of %zu objects awake", activity.getActive().size(), activity.getObjectCount());
+	ImGui::Text("Despawn pool: %zu objects", Xplor::EngineManager::GetInstance()->getPooledObjectCount());
+	if (Xplor::IsAllocationCounterEnabled())
+		ImGui::Text("Heap allocations: %llu last frame", static_cast<unsigned long long>(Xplor::EngineManager::GetInstance()->getFrameAllocationCount()));
+	else
+		ImGui::Text("Heap allocations: not counted, build with XPLOR_COUNT_ALLOCATIONS");
+	const Xplor::FrameArena& frame_arena = Xplor::EngineManager::GetInstance()->getFrameArena();
+	// Usage is still changing while the draw list is built, the peak is from finished frames
+	ImGui::Text("Frame arena: %zu KB, peak %zu KB", frame_arena.getCapacity() / 1024, frame_arena.getPeak() / 1024);
+	if (ImGui::CollapsingHeader("Kinematics"))
+	{
+		// Narrower kernels can be forced to compare them in a running scene
+		int simd_level = static_cast<int>(Xplor::GetSimdLevel());
+		const int supported_level = static_cast<int>(Xplor::GetSupportedSimdLevel());
+		if (ImGui::SliderInt("SIMD level", &simd_level, 0, supported_level, Xplor::GetSimdLevelName(static_cast<Xplor::SimdLevel>(simd_level))))
+			Xplor::SetSimdLevel(static_cast<Xplor::SimdLevel>(simd_level));
+
+		static std::vector<Xplor::KinematicsBenchmarkResult> benchmark_results;
+		if (ImGui::Button("Run Benchmark"))
+			benchmark_results = Xplor::BenchmarkKinematics(100000, 100);
+		for (const auto& result : benchmark_results)
+		{
+			ImGui::Text("%-6s %10.0f objects/ms, max error %g", Xplor::GetSimdLevelName(result.level), result.objects_per_ms, result.max_error);
+		}
+	}
+
+	if (ImGui::CollapsingHeader("Pools"))
+	{
+		Xplor::ForEachPool([](const Xplor::BlockPool& pool) {
+			const Xplor::BlockPool::Stats stats = pool.getStats();
+			ImGui::Text("%-12s %4zu B %6zu of %6zu live, peak %zu, %zu chunks", pool.getName().c_str(),
+				stats.block_size, stats.live, stats.capacity, stats.peak, stats.chunks);
+		});
+	}
+
+#ifdef XPLOR_PROFILE
+	if (Xplor::Profiler::getCaptureFramesLeft() > 0)
+		ImGui::Text("Profiler: capturing, %u frames left", Xplor::Profiler::getCaptureFramesLeft());
+	else if (ImGui::Button("Capture Trace (F9)"))
+		Xplor::Profiler::beginCapture();
+#endif
+
+	const Xplor::SweepAndPrune& broadphase = Xplor::EngineManager::GetInstance()->getBroadphase();
+	ImGui::Text("Broadphase: %zu proxies, %zu overlaps (+%zu -%zu), %zu swaps", broadphase.getProxyCount(),
+		broadphase.getBeginPairs().size() + broadphase.getPersistPairs().size(),
+		broadphase.getBeginPairs().size(), broadphase.getEndPairs().size(), broadphase.getSwapCount());
+	const Xplor::LooseOctree& octree = Xplor::EngineManager::GetInstance()->getOctree();
+	ImGui::Text("Octree: %zu proxies in %zu nodes", octree.getProxyCount(), octree.getNodeCount());
+
+	// Timings are from the previous frame, the current one is still executing
+	const Xplor::TaskGraph& frame_graph = Xplor::EngineManager::GetInstance()->getFrameGraph();
+	if (frame_graph.getTaskCount() > 0 && ImGui::CollapsingHeader("Frame Graph"))
+	{
+		ImGui::Text("Frame %.3f ms, critical path %.3f ms", frame_graph.getExecutionMs(), frame_graph.getCriticalPathMs());
+		for (Xplor::TaskGraph::TaskId id = 0; id < frame_graph.getTaskCount(); id++)
+		{
+			const Xplor::TaskTiming& timing = frame_graph.getTaskTiming(id);
+			ImGui::Text("%s %-20s %7.3f - %7.3f ms", timing.on_critical_path ? "*" : " ",
+				frame_graph.getTaskName(id).c_str(), timing.start_ms, timing.end_ms);
+		}
+	}
+
+	// GPU results lag a few frames behind, the queries are only read once they are ready
+	const Xplor::GpuTimer& gpu_timer = Xplor::EngineManager::GetInstance()->getRenderer().getGpuTimer();
+	if (ImGui::CollapsingHeader("GPU"))
+	{
+		const float gpu_ms = gpu_timer.getLatestFrameMs();
+		const float cpu_ms = frame_graph.getExecutionMs();
+		ImGui::Text("GPU %.3f ms, CPU %.3f ms: %s bound", gpu_ms, cpu_ms, gpu_ms > cpu_ms ? "GPU" : "CPU");
+		ImGui::Text("Frames skipped, results not ready: %llu", static_cast<unsigned long long>(gpu_timer.getSkippedFrameCount()));
+
+		Xplor::GpuTimer::History history;
+		uint32_t offset = 0;
+		for (uint32_t pass = 0; pass < Xplor::GpuTimer::PASS_COUNT; pass++)
+		{
+			const Xplor::GpuPass gpu_pass = static_cast<Xplor::GpuPass>(pass);
+			gpu_timer.getHistory(gpu_pass, history, offset);
+			const float latest = history[(offset + Xplor::GpuTimer::HISTORY_SIZE - 1) % Xplor::GpuTimer::HISTORY_SIZE];
+			char overlay[32];
+			std::snprintf(overlay, sizeof(overlay), "%.3f ms", latest);
+			ImGui::PlotLines(Xplor::GpuTimer::GetPassName(gpu_pass), history.data(), static_cast<int>(history.size()),
+				static_cast<int>(offset), overlay, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+		}
+	}
 	ImGui::End();
 }